@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+
+// Debounced button events delivered by core/input_scanner
+enum class ButtonEvent : uint8_t {
+  Press,
+  Release,
+  LongPress   // held for LONG_PRESS_MS (fires once per press)
+};
+
+// Anything input_scanner can deliver events to (Device implements this).
+// Kept free of Arduino types so the scanner also builds for the host.
+class ButtonListener {
+public:
+  virtual ~ButtonListener() {}
+
+  // Called by input_scanner for buttons this listener attached
+  virtual void onButton(uint8_t /*pin*/, ButtonEvent /*ev*/) {}
+};
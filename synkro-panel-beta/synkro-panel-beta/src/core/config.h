@@ -8,11 +8,23 @@
 #define DEVICE_ID   "synkro_res_p_beta"
 #define DEVICE_NAME "IEFP_AUDITORIUM"
 
+// Advertised in mDNS TXT ("fw", "caps") and MQTT discovery
+#define FIRMWARE_VERSION "0.4.0-beta"
+// ("ws" only when LAN control is enabled, i.e. LAN_CONTROL_TOKEN is set)
+#define DEVICE_CAPS_BASE "light,metrics"
+#define DEVICE_CAPS      (sizeof(LAN_CONTROL_TOKEN) > 1 ? DEVICE_CAPS_BASE ",ws" \
+                                                       : DEVICE_CAPS_BASE)
+
 // ---------- MQTT Broker (TCP for ESP32) ----------
 #define BROKER_IP     "10.30.14.37"
 //home test "192.168.1.90"
 #define BROKER_PORT  1883
 
+// PubSubClient packet buffer (default 256 is too small for metrics / stall JSON)
+#ifndef MQTT_BUFFER_SIZE
+  #define MQTT_BUFFER_SIZE 1024
+#endif
+
 // Optional: mDNS hostname of the broker (without .local) — hint for UI
 #ifndef BROKER_MDNS
   #define BROKER_MDNS "synkro-discovery"
@@ -22,3 +34,62 @@
 #define BUTTON_PIN   25
 #define RELAY_PIN    26
 
+// ---------- Buttons (core/input_scanner) ----------
+// Bank sample period; a press must be stable for 4 samples (~20 ms)
+#define INPUT_SCAN_MS   5UL
+#define LONG_PRESS_MS   800UL
+
+// ---------- Control payloads ----------
+// Larger control messages (MQTT or LAN) are rejected without parsing
+#define CONTROL_MAX_PAYLOAD 128
+
+// ---------- JSON arena (core/json_arena) ----------
+// Shared buffer for all JsonDocuments of one message; check the
+// high-water mark in /metrics before shrinking it
+#ifndef JSON_ARENA_SIZE
+  #define JSON_ARENA_SIZE 8192
+#endif
+
+// ---------- State persistence ----------
+// Restore the last relay state after a reboot / brownout (0 = always boot OFF)
+#ifndef PERSIST_RELAY_STATE
+  #define PERSIST_RELAY_STATE 1
+#endif
+// Minimum time between two NVS commits of the same key
+#ifndef STATE_COMMIT_MIN_MS
+  #define STATE_COMMIT_MIN_MS 5000UL
+#endif
+
+// ---------- Metrics ----------
+// Also publish metrics JSON on synkro/devices/<ID>/metrics (GET /metrics is always on)
+#ifndef METRICS_MQTT_ENABLED
+  #define METRICS_MQTT_ENABLED 1
+#endif
+#ifndef METRICS_MQTT_MS
+  #define METRICS_MQTT_MS 60000UL
+#endif
+
+// ---------- LAN control (WebSocket ws://<ip>/ws) ----------
+// Shared secret clients must send first ({"auth":"..."}). Empty = disabled.
+// Disabled by default: set a per-site secret at build time
+// (-D LAN_CONTROL_TOKEN=\"...\"); it travels over plain ws:// on the LAN.
+#ifndef LAN_CONTROL_TOKEN
+  #define LAN_CONTROL_TOKEN ""
+#endif
+#define LAN_MAX_CLIENTS   4
+#define LAN_MAX_PAYLOAD   CONTROL_MAX_PAYLOAD
+
+// ---------- Loop-stall watchdog ----------
+// loop() passes slower than this are recorded (phase + trail, see loop_watchdog.h)
+#ifndef LOOP_STALL_BUDGET_MS
+  #define LOOP_STALL_BUDGET_MS 1000UL
+#endif
+// Budget for setup() until the first loop() pass; above the 20 s Wi-Fi
+// connect timeout so a normal boot is not recorded as a stall
+#ifndef LOOP_STALL_SETUP_MS
+  #define LOOP_STALL_SETUP_MS 30000UL
+#endif
+// Reboot if a single stall lasts this long (0 = never reboot, only record)
+#ifndef LOOP_STALL_REBOOT_MS
+  #define LOOP_STALL_REBOOT_MS 0
+#endif
@@ -0,0 +1,66 @@
+// src/core/control_protocol.cpp
+#include "control_protocol.h"
+#include <string.h>
+#include <ArduinoJson.h>
+#include "json_arena.h"
+#include "config.h"
+
+using control_protocol::Action;
+
+// Control JSON is flat; anything deeper is not ours
+static const uint8_t NESTING_LIMIT = 2;
+
+static const char TOPIC_PREFIX[] = "synkro/devices/";
+
+// -------- public API --------
+Action control_protocol::parse(const char* json, size_t len) {
+  json_arena::Scope arena;
+  return parse(json, len, json_arena::allocator());
+}
+
+Action control_protocol::parse(const char* json, size_t len, ArduinoJson::Allocator* allocator) {
+  if (!json || len == 0 || len > CONTROL_MAX_PAYLOAD) return Action::None;
+
+  JsonDocument doc(allocator);
+  DeserializationError err = deserializeJson(
+    doc, json, len, DeserializationOption::NestingLimit(NESTING_LIMIT));
+  if (err) return Action::None;
+
+  // {"toggle":true} wins over "action", as before
+  if (doc["toggle"].is<bool>() && doc["toggle"].as<bool>()) {
+    return Action::Toggle;
+  }
+
+  const char* a = doc["action"].as<const char*>();
+  if (!a) return Action::None;
+  if (strcmp(a, "on") == 0)  return Action::On;
+  if (strcmp(a, "off") == 0) return Action::Off;
+  return Action::None;
+}
+
+bool control_protocol::topicIs(const char* topic, const char* deviceId, const char* suffix) {
+  if (!topic || !deviceId || !suffix) return false;
+
+  const size_t prefixLen = sizeof(TOPIC_PREFIX) - 1;
+  if (strncmp(topic, TOPIC_PREFIX, prefixLen) != 0) return false;
+  topic += prefixLen;
+
+  const size_t idLen = strlen(deviceId);
+  if (strncmp(topic, deviceId, idLen) != 0) return false;
+  topic += idLen;
+
+  if (*topic != '/') return false;
+  return strcmp(topic + 1, suffix) == 0;
+}
+
+size_t control_protocol::writeLightState(char* out, size_t cap, const char* deviceId, bool on) {
+  json_arena::Scope arena;
+  JsonDocument doc(json_arena::allocator());
+  doc["deviceId"] = deviceId;
+  doc["light"]    = on ? "on" : "off";
+
+  // serializeJson() truncates silently; measure first
+  const size_t need = measureJson(doc);
+  if (!out || need + 1 > cap) return 0;
+  return serializeJson(doc, out, cap);
+}
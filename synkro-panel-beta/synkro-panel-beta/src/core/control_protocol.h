@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Control payload parsing / topic matching / state serialization for Synkro.
+// Shared by MQTT (synkro/devices/<ID>/control) and LAN WebSocket control.
+//
+// Everything here is plain C++ + ArduinoJson (no Arduino.h, no String),
+// so it can be compiled for a host target, and it never trusts its input:
+//  - payloads longer than CONTROL_MAX_PAYLOAD are rejected before parsing
+//  - JSON nesting is limited, so deep documents can't exhaust the stack
+//  - no heap String copies of the payload or topic
+
+namespace control_protocol {
+
+  enum class Action : uint8_t {
+    None,     // malformed, oversized or unknown → ignore
+    On,
+    Off,
+    Toggle
+  };
+
+  // Parse {"action":"on"} | {"action":"off"} | {"toggle":true}.
+  // json need not be NUL-terminated. Uses the shared json_arena.
+  Action parse(const char* json, size_t len);
+
+  // Same, with an explicit allocator (benchmarks / allocation counting).
+  // The caller owns any json_arena::Scope the allocator may need.
+  Action parse(const char* json, size_t len, ArduinoJson::Allocator* allocator);
+
+  // True if topic == "synkro/devices/<deviceId>/<suffix>".
+  bool topicIs(const char* topic, const char* deviceId, const char* suffix);
+
+  // Write {"deviceId":"<deviceId>","light":"on|off"} into out.
+  // Returns the length written (0 if it did not fit).
+  size_t writeLightState(char* out, size_t cap, const char* deviceId, bool on);
+
+} // namespace control_protocol
@@ -0,0 +1,159 @@
+// src/core/input_scanner.cpp
+#include "input_scanner.h"
+#include "config.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+#endif
+
+// -------- statics --------
+static const uint8_t MAX_BUTTONS = 16;
+
+struct Button {
+  uint8_t         pin;
+  ButtonListener* listener;
+  uint32_t        pressedMs;
+  bool            longFired;
+  bool            pressSent;   // Release only pairs with a reported Press
+};
+
+static Button   sButtons[MAX_BUTTONS];
+static uint8_t  sButtonCount = 0;
+static uint64_t sMask        = 0;     // bits of attached pins
+
+static input_scanner::PinReader sReader = nullptr;
+static input_scanner::Clock     sClock  = nullptr;
+
+// Vertical counters: bit n of each word belongs to pin n
+static uint64_t sState = 0;           // debounced, 1 = pressed
+static uint64_t sCnt0  = 0;
+static uint64_t sCnt1  = 0;
+static bool     sSeeded = false;
+
+static uint32_t sLastScan = 0;
+
+// -------- internal helpers --------
+static uint64_t readGpioBank() {
+#ifdef ARDUINO
+  // GPIO 0..31 and 32..39 in two register reads
+  uint64_t lo = REG_READ(GPIO_IN_REG);
+  uint64_t hi = REG_READ(GPIO_IN1_REG) & 0xFFULL;
+  return (hi << 32) | lo;
+#else
+  return ~0ULL;                        // no hardware: everything released
+#endif
+}
+
+static inline uint64_t readPressed() {
+  uint64_t raw = sReader ? sReader() : readGpioBank();
+  return ~raw & sMask;                 // active-LOW
+}
+
+static inline uint32_t nowMs() {
+  if (sClock) return sClock();
+#ifdef ARDUINO
+  return millis();
+#else
+  return 0;
+#endif
+}
+
+static void dispatch(uint64_t pressedEdges, uint64_t releasedEdges, uint32_t now) {
+  for (uint8_t i = 0; i < sButtonCount; i++) {
+    Button& b = sButtons[i];
+    const uint64_t bit = 1ULL << b.pin;
+
+    if (pressedEdges & bit) {
+      b.pressedMs = now;
+      b.longFired = false;
+      b.pressSent = true;
+      b.listener->onButton(b.pin, ButtonEvent::Press);
+    } else if (releasedEdges & bit) {
+      // A button held at boot was never reported as pressed
+      if (!b.pressSent) continue;
+      b.pressSent = false;
+      b.listener->onButton(b.pin, ButtonEvent::Release);
+    } else if ((sState & bit) && !b.longFired &&
+               now - b.pressedMs >= LONG_PRESS_MS) {
+      b.longFired = true;
+      b.listener->onButton(b.pin, ButtonEvent::LongPress);
+    }
+  }
+}
+
+// -------- public API --------
+void input_scanner::attach(uint8_t pin, ButtonListener* listener) {
+  if (!listener || pin >= 64) return;
+  if (sButtonCount >= MAX_BUTTONS) {
+#ifdef ARDUINO
+    Serial.print("[INPUT] Too many buttons, ignoring pin ");
+    Serial.println(pin);
+#endif
+    return;
+  }
+
+#ifdef ARDUINO
+  if (!sReader) pinMode(pin, INPUT_PULLUP);
+#endif
+
+  Button& b = sButtons[sButtonCount++];
+  b.pin       = pin;
+  b.listener  = listener;
+  b.pressedMs = 0;
+  b.longFired = true;   // no LongPress until a real Press was seen
+  b.pressSent = false;
+
+  sMask |= 1ULL << pin;
+}
+
+void input_scanner::setPinReader(PinReader reader) {
+  sReader = reader;
+}
+
+void input_scanner::setClock(Clock clock) {
+  sClock = clock;
+}
+
+void input_scanner::reset() {
+  sButtonCount = 0;
+  sMask        = 0;
+  sReader      = nullptr;
+  sClock       = nullptr;
+  sState = sCnt0 = sCnt1 = 0;
+  sSeeded      = false;
+  sLastScan    = 0;
+}
+
+void input_scanner::loop() {
+  if (!sMask) return;
+
+  uint32_t now = nowMs();
+  if (sSeeded && now - sLastScan < INPUT_SCAN_MS) return;
+  sLastScan = now;
+
+  uint64_t sample = readPressed();
+
+  if (!sSeeded) {
+    // Buttons held at boot are not reported as presses
+    sState  = sample;
+    sSeeded = true;
+    return;
+  }
+
+  // 2-bit vertical counter per pin: counts scans where sample != state,
+  // resets when they agree; state flips after 4 differing scans.
+  uint64_t delta = sample ^ sState;
+  sCnt1 = (sCnt1 ^ sCnt0) & delta;
+  sCnt0 = ~sCnt0 & delta;
+  uint64_t flips = delta & ~(sCnt0 | sCnt1);
+  sState ^= flips;
+
+  uint64_t pressedEdges  = flips & sState;
+  uint64_t releasedEdges = flips & ~sState;
+
+  // Nothing changed and nothing held → no per-button work at all
+  if (!flips && !sState) return;
+
+  dispatch(pressedEdges, releasedEdges, now);
+}
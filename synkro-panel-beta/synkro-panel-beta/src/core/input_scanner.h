@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "button_event.h"
+
+// Shared button scanner for Synkro panels.
+// Handles:
+//  - ONE bulk read of all button inputs per scan (GPIO_IN / GPIO_IN1 registers)
+//  - debouncing every button at once with 2-bit vertical counters
+//    (a level must be stable for 4 consecutive scans to count)
+//  - Press / Release / LongPress events to the attached listener (Device);
+//    every Release pairs with an earlier Press (held-at-boot → neither)
+//
+// Buttons are active-LOW with the internal pull-up (wired to GND).
+//
+// Pin bank
+// --------
+// By default bit n of the bank is GPIO n. setPinReader() replaces the
+// register read, e.g. with one I/O-expander transaction or a simulated
+// bank; "pin" then means the bit index in whatever that reader returns.
+//
+// No Arduino dependency outside #ifdef ARDUINO: with setPinReader() and
+// setClock() the scanner runs on the host (test/test_input_scanner).
+
+namespace input_scanner {
+
+  // Returns the raw level of the whole bank (bit = 1 → HIGH).
+  using PinReader = uint64_t (*)();
+
+  // Returns the current time in ms (wraps like millis()).
+  using Clock = uint32_t (*)();
+
+  // Register a button; listener->onButton(pin, ...) receives its events.
+  // Configures the GPIO as INPUT_PULLUP unless a custom reader is set.
+  void attach(uint8_t pin, ButtonListener* listener);
+
+  // Swap the bank reader (nullptr → on-chip GPIO registers).
+  // Call before attach().
+  void setPinReader(PinReader reader);
+
+  // Swap the time source (nullptr → millis()).
+  void setClock(Clock clock);
+
+  // Forget all buttons, debounce state, reader and clock (host tests).
+  void reset();
+
+  // Call every loop() pass. Samples at most once per INPUT_SCAN_MS.
+  void loop();
+
+} // namespace input_scanner
@@ -0,0 +1,126 @@
+// src/core/json_arena.cpp
+#include "json_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+// -------- statics --------
+// Each block is [size_t size][payload], aligned for any JSON value
+static const size_t ALIGN  = alignof(max_align_t);
+static const size_t HEADER = (sizeof(size_t) + ALIGN - 1) & ~(ALIGN - 1);
+
+alignas(max_align_t) static uint8_t sBuf[JSON_ARENA_SIZE];
+static size_t   sTop       = 0;         // next free offset
+static uint8_t* sLast      = nullptr;   // payload of the most recent block
+static uint8_t  sDepth     = 0;         // nested Scopes
+
+static size_t   sHighWater = 0;
+static uint32_t sOverflows = 0;
+
+// -------- internal helpers --------
+static inline size_t alignUp(size_t n) {
+  return (n + ALIGN - 1) & ~(ALIGN - 1);
+}
+
+static inline bool inArena(const void* p) {
+  const uint8_t* b = static_cast<const uint8_t*>(p);
+  return b >= sBuf && b < sBuf + sizeof(sBuf);
+}
+
+static inline size_t& blockSize(uint8_t* payload) {
+  return *reinterpret_cast<size_t*>(payload - HEADER);
+}
+
+static void* heapFallback(size_t size) {
+  sOverflows++;
+  return malloc(size);
+}
+
+class ArenaAllocator : public ArduinoJson::Allocator {
+public:
+  void* allocate(size_t size) override {
+    // Outside a Scope nothing would ever reset the arena
+    if (!sDepth) return heapFallback(size);
+
+    size_t need = HEADER + alignUp(size);
+    if (need > sizeof(sBuf) - sTop) return heapFallback(size);
+
+    uint8_t* payload = sBuf + sTop + HEADER;
+    blockSize(payload) = size;
+    sTop += need;
+    sLast = payload;
+    if (sTop > sHighWater) sHighWater = sTop;
+    return payload;
+  }
+
+  void deallocate(void* ptr) override {
+    if (!ptr) return;
+    if (!inArena(ptr)) {
+      free(ptr);
+      return;
+    }
+    // Only the newest block can be given back early; the rest waits
+    // for the Scope to end.
+    if (ptr == sLast) {
+      sTop  = static_cast<size_t>(sLast - sBuf) - HEADER;
+      sLast = nullptr;
+    }
+  }
+
+  void* reallocate(void* ptr, size_t newSize) override {
+    if (!ptr) return allocate(newSize);
+    if (!inArena(ptr)) return realloc(ptr, newSize);
+
+    uint8_t* payload = static_cast<uint8_t*>(ptr);
+    size_t   oldSize = blockSize(payload);
+
+    // Newest block: grow / shrink in place (pool growth, shrinkToFit)
+    if (payload == sLast) {
+      size_t start = static_cast<size_t>(payload - sBuf);
+      if (alignUp(newSize) <= sizeof(sBuf) - start) {
+        blockSize(payload) = newSize;
+        sTop = start + alignUp(newSize);
+        if (sTop > sHighWater) sHighWater = sTop;
+        return payload;
+      }
+    } else if (newSize <= oldSize) {
+      return payload;
+    }
+
+    void* moved = allocate(newSize);
+    if (!moved) return nullptr;
+    memcpy(moved, payload, oldSize < newSize ? oldSize : newSize);
+    deallocate(payload);
+    return moved;
+  }
+};
+
+static ArenaAllocator sAllocator;
+
+// -------- public API --------
+ArduinoJson::Allocator* json_arena::allocator() {
+  return &sAllocator;
+}
+
+json_arena::Scope::Scope() {
+  sDepth++;
+}
+
+json_arena::Scope::~Scope() {
+  if (sDepth && --sDepth == 0) {
+    sTop  = 0;
+    sLast = nullptr;
+  }
+}
+
+size_t json_arena::capacity() {
+  return sizeof(sBuf);
+}
+
+size_t json_arena::highWater() {
+  return sHighWater;
+}
+
+uint32_t json_arena::overflows() {
+  return sOverflows;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Shared fixed-size arena for ArduinoJson v7 documents.
+// Handles:
+//  - a static JSON_ARENA_SIZE buffer handed out by bump allocation
+//  - reset at the end of the outermost Scope (i.e. once per message)
+//  - heap fallback + overflow counter when a message doesn't fit
+//  - high-water mark, so JSON_ARENA_SIZE can be sized from the field
+//
+// v7 dropped StaticJsonDocument: every JsonDocument allocates its pools
+// from the heap. Plugging this allocator in keeps parse / serialize
+// off the general heap entirely.
+//
+// Usage (declare the Scope BEFORE the document so it outlives it):
+//
+//   json_arena::Scope arena;
+//   JsonDocument doc(json_arena::allocator());
+//
+// Scopes nest (e.g. reportState() → publishState()); the arena is only
+// reset when the outermost one ends. Main loop task only – not thread-safe.
+// Plain C++ + ArduinoJson, like control_protocol.
+
+namespace json_arena {
+
+  ArduinoJson::Allocator* allocator();
+
+  class Scope {
+  public:
+    Scope();
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+  size_t   capacity();
+  size_t   highWater();     // most bytes ever in use at once
+  uint32_t overflows();     // allocations that fell back to the heap
+
+} // namespace json_arena
@@ -0,0 +1,223 @@
+// src/core/lan_control.cpp
+#include "lan_control.h"
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include "json_arena.h"
+#include "config.h"
+#include "mqtt_manager.h"
+#include "metrics.h"
+#include "control_protocol.h"
+#include "devices/LightingDevice.h"
+
+// -------- statics --------
+static AsyncWebSocket sWs("/ws");
+
+static const char*     sDeviceId  = nullptr;
+static const char*     sToken     = nullptr;
+static LightingDevice* sMainLight = nullptr;
+static bool            sStarted   = false;
+
+// Events handed from the async_tcp task to loop()
+enum class EvtKind : uint8_t { Connect, Disconnect, Data };
+
+struct WsEvent {
+  EvtKind  kind;
+  uint32_t client;
+  uint16_t len;
+  char     payload[LAN_MAX_PAYLOAD + 1];
+};
+
+static QueueHandle_t   sQueue     = nullptr;
+static const uint8_t   QUEUE_LEN  = 8;
+
+// Authenticated clients (only touched from loop())
+static uint32_t        sAuthed[LAN_MAX_CLIENTS];
+static uint8_t         sAuthedCount = 0;
+
+static bool            sLastPushedOn = false;
+static unsigned long   sLastCleanup  = 0;
+static const unsigned long CLEANUP_MS = 1000UL;
+
+// -------- internal helpers --------
+static bool isAuthed(uint32_t id) {
+  for (uint8_t i = 0; i < sAuthedCount; i++) {
+    if (sAuthed[i] == id) return true;
+  }
+  return false;
+}
+
+static void removeAuthed(uint32_t id) {
+  for (uint8_t i = 0; i < sAuthedCount; i++) {
+    if (sAuthed[i] == id) {
+      sAuthed[i] = sAuthed[--sAuthedCount];
+      return;
+    }
+  }
+}
+
+// Compare without early exit so the token can't be guessed by timing
+static bool tokenMatches(const char* given) {
+  if (!given || !sToken) return false;
+  size_t a = strlen(given);
+  size_t b = strlen(sToken);
+  uint8_t diff = (a != b);
+  for (size_t i = 0; i < b; i++) {
+    diff |= (uint8_t)(sToken[i] ^ (i < a ? given[i] : 0));
+  }
+  return diff == 0;
+}
+
+static const char* stateMessage(char* buf, size_t cap) {
+  bool on = sMainLight && sMainLight->isOn();
+  if (!control_protocol::writeLightState(buf, cap, sDeviceId, on)) buf[0] = '\0';
+  return buf;
+}
+
+static void pushState() {
+  if (!sAuthedCount) return;
+  char msg[96];
+  stateMessage(msg, sizeof(msg));
+  for (uint8_t i = 0; i < sAuthedCount; i++) {
+    sWs.text(sAuthed[i], msg);
+  }
+}
+
+// Push on ANY change (button, MQTT or LAN)
+static void pushIfChanged() {
+  bool on = sMainLight && sMainLight->isOn();
+  if (on == sLastPushedOn) return;
+  sLastPushedOn = on;
+  pushState();
+}
+
+static void handleData(const WsEvent& ev) {
+  if (!isAuthed(ev.client)) {
+    json_arena::Scope arena;
+    JsonDocument doc(json_arena::allocator());
+    if (deserializeJson(doc, ev.payload, ev.len) ||
+        !tokenMatches(doc["auth"].as<const char*>()) ||
+        sAuthedCount >= LAN_MAX_CLIENTS) {
+      Serial.printf("[LAN] Client #%u rejected\n", (unsigned)ev.client);
+      sWs.close(ev.client);
+      return;
+    }
+    sAuthed[sAuthedCount++] = ev.client;
+    Serial.printf("[LAN] Client #%u authenticated\n", (unsigned)ev.client);
+    sWs.text(ev.client, "{\"auth\":\"ok\"}");
+    char msg[96];
+    sWs.text(ev.client, stateMessage(msg, sizeof(msg)));
+    return;
+  }
+
+  if (!sMainLight) return;
+
+  // Same control JSON as synkro/devices/<ID>/control
+  unsigned long t0 = micros();
+  control_protocol::Action action = control_protocol::parse(ev.payload, ev.len);
+  metrics::recordControl(micros() - t0, action != control_protocol::Action::None);
+  if (action == control_protocol::Action::None) return;
+  sMainLight->applyControl(action);
+
+  // LAN clients first (single hop), then ONE report to keep the broker /
+  // web UI in sync (cheap no-op if MQTT is down)
+  pushIfChanged();
+  mqtt_runtime::notifyStateChanged();
+}
+
+// Runs on the async_tcp task: copy and hand over, nothing else
+static void onWsEvent(AsyncWebSocket* server,
+                      AsyncWebSocketClient* client,
+                      AwsEventType type,
+                      void* arg,
+                      uint8_t* data,
+                      size_t len) {
+  WsEvent ev;
+  ev.client = client->id();
+  ev.len    = 0;
+
+  if (type == WS_EVT_CONNECT) {
+    ev.kind = EvtKind::Connect;
+  } else if (type == WS_EVT_DISCONNECT) {
+    ev.kind = EvtKind::Disconnect;
+  } else if (type == WS_EVT_DATA) {
+    AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+    // Only single-frame text messages; control JSON is tiny
+    if (!info->final || info->index != 0 || info->len != len ||
+        info->opcode != WS_TEXT || len > LAN_MAX_PAYLOAD) {
+      client->close();
+      return;
+    }
+    ev.kind = EvtKind::Data;
+    ev.len  = len;
+    memcpy(ev.payload, data, len);
+  } else {
+    return;
+  }
+  ev.payload[ev.len] = '\0';
+
+  // Never block the network task; a full queue drops the event
+  if (xQueueSend(sQueue, &ev, 0) != pdTRUE && ev.kind == EvtKind::Data) {
+    client->close();
+  }
+}
+
+// -------- public API --------
+void lan_control::begin(AsyncWebServer& server,
+                        const char* deviceId,
+                        const char* token,
+                        LightingDevice* mainLight) {
+  if (!token || !strlen(token)) {
+    Serial.println("[LAN] No token configured → WebSocket control disabled");
+    return;
+  }
+
+  sDeviceId  = deviceId;
+  sToken     = token;
+  sMainLight = mainLight;
+
+  sQueue = xQueueCreate(QUEUE_LEN, sizeof(WsEvent));
+  if (!sQueue) return;
+
+  sLastPushedOn = sMainLight && sMainLight->isOn();
+
+  sWs.onEvent(onWsEvent);
+  server.addHandler(&sWs);
+  sStarted = true;
+
+  Serial.println("[LAN] WebSocket control on /ws");
+}
+
+void lan_control::loop() {
+  if (!sStarted) return;
+
+  WsEvent ev;
+  while (xQueueReceive(sQueue, &ev, 0) == pdTRUE) {
+    switch (ev.kind) {
+      case EvtKind::Connect:
+        Serial.printf("[LAN] Client #%u connected\n", (unsigned)ev.client);
+        break;
+      case EvtKind::Disconnect:
+        removeAuthed(ev.client);
+        break;
+      case EvtKind::Data:
+        handleData(ev);
+        break;
+    }
+  }
+
+  // Changes from the button or MQTT, within one loop pass
+  pushIfChanged();
+
+  unsigned long now = millis();
+  if (now - sLastCleanup > CLEANUP_MS) {
+    sLastCleanup = now;
+    sWs.cleanupClients(LAN_MAX_CLIENTS);
+
+    // Drop ids whose Disconnect event was lost to a full queue
+    for (uint8_t i = 0; i < sAuthedCount; ) {
+      if (sWs.hasClient(sAuthed[i])) i++;
+      else sAuthed[i] = sAuthed[--sAuthedCount];
+    }
+  }
+}
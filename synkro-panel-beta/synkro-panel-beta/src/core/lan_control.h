@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+class AsyncWebServer;
+class LightingDevice;
+
+// Direct LAN control for Synkro over WebSocket (STA mode only).
+// Handles:
+//  - ws://<sta_ip>/ws on the shared wifi_portal server
+//  - per-client authentication with a shared token
+//  - the same control JSON as MQTT (synkro/devices/<ID>/control)
+//  - pushing state to authenticated clients as soon as it changes
+//
+// Protocol
+// --------
+//   client → {"auth":"<LAN_CONTROL_TOKEN>"}
+//   panel  → {"auth":"ok"} then {"deviceId":"...","light":"on|off"}
+//   client → {"action":"on"} | {"action":"off"} | {"toggle":true}
+//   panel  → {"deviceId":"...","light":"on|off"} on every state change
+//
+// Anything other than a valid auth message from an unauthenticated client
+// closes the connection.
+//
+// Threading
+// ---------
+// AsyncWebSocket events arrive on the async_tcp task. They are only copied
+// into a small FreeRTOS queue there; parsing, relay changes and MQTT all
+// happen in loop() on the main task, like every other control path.
+// This keeps working when the broker is down (single hop UI → panel).
+
+namespace lan_control {
+
+  // Register the /ws endpoint. token must be non-empty, otherwise the
+  // endpoint is not started.
+  void begin(AsyncWebServer& server,
+             const char* deviceId,
+             const char* token,
+             LightingDevice* mainLight);
+
+  // Call in loop() while Wi-Fi is connected (independent of MQTT state).
+  void loop();
+
+} // namespace lan_control
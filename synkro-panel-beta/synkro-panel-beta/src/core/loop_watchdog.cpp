@@ -0,0 +1,240 @@
+// src/core/loop_watchdog.cpp
+#include "loop_watchdog.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include "config.h"
+
+using loop_watchdog::Phase;
+
+// -------- statics --------
+static const uint32_t MAGIC      = 0x53544C4CUL;   // "STLL"
+static const uint8_t  TRAIL_LEN  = 8;
+static const uint32_t CHECK_MS   = 50;
+
+static const char* const PHASE_NAMES[] = {
+  "idle", "input", "state_store", "wifi_connect", "mqtt_connect",
+  "mqtt_loop", "mqtt_report", "lan_control", "provisioning"
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) ==
+              static_cast<size_t>(Phase::Count), "PHASE_NAMES out of sync");
+
+// Last stall; RTC memory survives esp_restart() / watchdog resets
+struct StallRecord {
+  uint32_t magic;
+  uint32_t count;            // stalls since power-on
+  uint32_t atUptimeMs;       // last completed loop() before the stall
+  uint32_t durationMs;
+  uint32_t trail[TRAIL_LEN]; // phase entry/exit sites, oldest first
+  uint8_t  phase;
+  uint8_t  active;           // still stalled (→ reboot happened mid-stall)
+  uint8_t  resetReason;      // esp_reset_reason_t if it ended in a reboot
+  uint8_t  logged;           // printed on Serial
+  uint8_t  reported;         // published on MQTT
+};
+RTC_NOINIT_ATTR static StallRecord sRecord;
+
+// A stall that ended in a reboot, moved aside when a newer stall is
+// captured before it was published (the reboot case must reach MQTT)
+RTC_NOINIT_ATTR static StallRecord sHeld;
+
+// Guards sRecord, sHeld and sHeartbeatMs between the loop task (feed,
+// report) and the watchdog task on the other core
+static portMUX_TYPE sLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Live state (loop task writes, watchdog task reads)
+static volatile uint32_t sHeartbeatMs = 0;
+static volatile bool     sArmed       = false;
+static volatile bool     sInLoop      = false;   // first feed() seen
+static volatile uint8_t  sPhase       = static_cast<uint8_t>(Phase::Idle);
+static volatile uint32_t sTrail[TRAIL_LEN];
+static volatile uint8_t  sTrailHead   = 0;
+
+static uint32_t sBudgetMs = 1000;
+static bool     sInStall  = false;   // watchdog task only
+
+// -------- internal helpers --------
+static inline bool heldPending() {
+  return sHeld.count && !sHeld.reported;
+}
+
+static const char* phaseName(uint8_t p) {
+  return p < static_cast<uint8_t>(Phase::Count) ? PHASE_NAMES[p] : "?";
+}
+
+static uint32_t cleanPc(uint32_t ra) {
+#if defined(__XTENSA__)
+  // Windowed ABI keeps the call size in the top 2 bits
+  return (ra & 0x3FFFFFFFUL) | 0x40000000UL;
+#else
+  return ra;
+#endif
+}
+
+static void logRecord() {
+  Serial.printf("[WDT] Loop stalled %lu ms in phase '%s' at uptime %lu ms%s (stall #%lu)\n",
+                (unsigned long)sRecord.durationMs,
+                phaseName(sRecord.phase),
+                (unsigned long)sRecord.atUptimeMs,
+                sRecord.resetReason ? ", ended in REBOOT" : "",
+                (unsigned long)sRecord.count);
+  Serial.print("[WDT] Trail:");
+  for (uint8_t i = 0; i < TRAIL_LEN; i++) {
+    if (!sRecord.trail[i]) continue;
+    Serial.printf(" 0x%08lx", (unsigned long)sRecord.trail[i]);
+  }
+  Serial.println();
+  sRecord.logged = 1;
+}
+
+// Caller holds sLock
+static void captureStall(uint32_t since) {
+  // Never overwrite an unpublished reboot record: park it in sHeld
+  if (sRecord.resetReason && !sRecord.reported) sHeld = sRecord;
+
+  sRecord.count++;
+  sRecord.atUptimeMs  = sHeartbeatMs;
+  sRecord.durationMs  = since;
+  sRecord.phase       = sPhase;
+  sRecord.resetReason = 0;
+  sRecord.logged      = 0;
+  sRecord.reported    = 0;
+
+  // Unroll the ring oldest → newest
+  uint8_t head = sTrailHead;
+  for (uint8_t i = 0; i < TRAIL_LEN; i++) {
+    sRecord.trail[i] = sTrail[(head + i) % TRAIL_LEN];
+  }
+  sRecord.active = 1;
+}
+
+// Runs on core 0 so a loop() spinning on core 1 can't starve it.
+// Never touches Serial: the loop task may be stuck inside it.
+static void watchTask(void*) {
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(CHECK_MS));
+    if (!sArmed) continue;
+
+    // Heartbeat read + capture are one step: a feed() in between would
+    // otherwise be undone (active set again, stale duration written).
+    portENTER_CRITICAL(&sLock);
+    // setup() (Wi-Fi connect: up to 20 s) gets its own, larger budget
+    uint32_t budget = sInLoop ? sBudgetMs : LOOP_STALL_SETUP_MS;
+    uint32_t since = millis() - sHeartbeatMs;
+    bool stalled = since > budget;
+    if (stalled) {
+      if (!sInStall) {
+        sInStall = true;
+        captureStall(since);
+      }
+      if (sRecord.active) sRecord.durationMs = since;
+    } else {
+      sInStall = false;
+    }
+    portEXIT_CRITICAL(&sLock);
+
+#if LOOP_STALL_REBOOT_MS
+    if (stalled && since > LOOP_STALL_REBOOT_MS) esp_restart();
+#endif
+  }
+}
+
+// -------- public API --------
+void loop_watchdog::begin(uint32_t budgetMs) {
+  sBudgetMs = budgetMs;
+
+  esp_reset_reason_t reason = esp_reset_reason();
+  if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT ||
+      sRecord.magic != MAGIC) {
+    memset(&sRecord, 0, sizeof(sRecord));
+    memset(&sHeld, 0, sizeof(sHeld));
+    sRecord.magic = MAGIC;
+  } else if (sRecord.active) {
+    // We rebooted while stalled
+    sRecord.active      = 0;
+    sRecord.resetReason = static_cast<uint8_t>(reason);
+    sRecord.logged      = 0;
+    sRecord.reported    = 0;
+  }
+
+  if (sRecord.count && !sRecord.logged) logRecord();
+
+  // Arm now: setup() is watched too, against LOOP_STALL_SETUP_MS
+  sHeartbeatMs = millis();
+  sArmed = true;
+
+  xTaskCreatePinnedToCore(watchTask, "loop_wd", 2048, nullptr, 2, nullptr, 0);
+}
+
+void loop_watchdog::feed() {
+  portENTER_CRITICAL(&sLock);
+  uint32_t now = millis();
+  uint32_t since = now - sHeartbeatMs;
+  sHeartbeatMs = now;
+  sInLoop = true;                     // loop() budget from here on
+
+  if (sRecord.active) {
+    // Recovered: exact duration, then log from the loop task
+    sRecord.durationMs = since;
+    sRecord.active = 0;
+  }
+  bool needLog = sRecord.count && !sRecord.logged;
+  portEXIT_CRITICAL(&sLock);
+
+  if (needLog) logRecord();
+}
+
+__attribute__((noinline)) void loop_watchdog::setPhase(Phase p) {
+  sPhase = static_cast<uint8_t>(p);
+  uint8_t head = sTrailHead;
+  sTrail[head] = cleanPc((uint32_t)reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+  sTrailHead = (head + 1) % TRAIL_LEN;
+}
+
+Phase loop_watchdog::phase() {
+  return static_cast<Phase>(sPhase);
+}
+
+uint32_t loop_watchdog::stallCount() {
+  return sRecord.count;
+}
+
+bool loop_watchdog::hasUnreported() {
+  portENTER_CRITICAL(&sLock);
+  bool pending = heldPending() ||
+                 (sRecord.count && !sRecord.active && !sRecord.reported);
+  portEXIT_CRITICAL(&sLock);
+  return pending;
+}
+
+uint32_t loop_watchdog::fillReport(JsonObject obj) {
+  // Consistent copy: a new stall may be captured while we serialize.
+  // A parked reboot record goes out first.
+  portENTER_CRITICAL(&sLock);
+  StallRecord rec = heldPending() ? sHeld : sRecord;
+  portEXIT_CRITICAL(&sLock);
+
+  obj["count"]      = rec.count;
+  obj["phase"]      = phaseName(rec.phase);
+  obj["durationMs"] = rec.durationMs;
+  obj["atUptimeMs"] = rec.atUptimeMs;
+  obj["rebooted"]   = rec.resetReason != 0;
+  if (rec.resetReason) obj["resetReason"] = rec.resetReason;
+
+  JsonArray trail = obj["trail"].to<JsonArray>();
+  char hex[11];
+  for (uint8_t i = 0; i < TRAIL_LEN; i++) {
+    if (!rec.trail[i]) continue;
+    snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)rec.trail[i]);
+    trail.add(hex);
+  }
+
+  return rec.count;
+}
+
+void loop_watchdog::markReported(uint32_t stall) {
+  portENTER_CRITICAL(&sLock);
+  if (heldPending() && sHeld.count == stall) sHeld.reported = 1;
+  else if (sRecord.count == stall)          sRecord.reported = 1;
+  portEXIT_CRITICAL(&sLock);
+}
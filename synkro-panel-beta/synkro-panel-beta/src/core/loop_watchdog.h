@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Software loop-stall watchdog for Synkro.
+// Handles:
+//  - a FreeRTOS task (core 0) that notices when loop() has not completed
+//    within LOOP_STALL_BUDGET_MS
+//  - which instrumented phase was active (Scope below) when it stalled
+//  - a breadcrumb "backtrace": return addresses of the last phase entries
+//  - keeping that record in RTC memory so it survives a soft reboot
+//  - reporting it on Serial after recovery / at boot, and on MQTT
+//    (synkro/devices/<ID>/stall, via mqtt_runtime)
+//
+// Instrumenting a blocking call:
+//
+//   loop_watchdog::Scope phase(loop_watchdog::Phase::MqttConnect);
+//   sMqtt.connect(...);
+//
+// Addresses in the trail can be resolved with addr2line against firmware.elf.
+
+namespace loop_watchdog {
+
+  enum class Phase : uint8_t {
+    Idle,
+    Input,          // input_scanner + device handle()
+    StateStore,     // NVS commit
+    WifiConnect,    // connectStaInternal()
+    MqttConnect,    // PubSubClient::connect()
+    MqttLoop,       // PubSubClient::loop() + callbacks
+    MqttReport,     // state / discovery publish + Serial logging
+    LanControl,     // WebSocket queue + pushes
+    Provisioning,   // AP portal idle
+    Count
+  };
+
+  // Start the watchdog task, armed from here on, so blocking setup()
+  // steps (e.g. WifiConnect) are caught too. Until the first feed() the
+  // budget is LOOP_STALL_SETUP_MS, then budgetMs.
+  // Also logs a stall record left by the previous boot, if any.
+  void begin(uint32_t budgetMs);
+
+  // Call at the end of every loop() pass.
+  void feed();
+
+  // Mark the currently running phase (prefer Scope).
+  void setPhase(Phase p);
+  Phase phase();
+
+  // RAII phase marker; restores the previous phase on exit.
+  class Scope {
+  public:
+    explicit Scope(Phase p) : _prev(phase()) { setPhase(p); }
+    ~Scope() { setPhase(_prev); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  private:
+    Phase _prev;
+  };
+
+  // Stalls recorded (persists across soft reboots).
+  uint32_t stallCount();
+
+  // A finished stall that has not been published yet?
+  bool hasUnreported();
+
+  // Fill obj with the oldest unpublished stall record (a stall that ended
+  // in a reboot is kept until published); returns its stall number.
+  uint32_t fillReport(JsonObject obj);
+
+  // Mark stall number `stall` as published (call only once it really was).
+  // No-op if a newer stall has been recorded since fillReport().
+  void markReported(uint32_t stall);
+
+} // namespace loop_watchdog
@@ -0,0 +1,42 @@
+// src/core/mdns_advert.cpp
+#include "mdns_advert.h"
+#include <Arduino.h>
+#include <ESPmDNS.h>
+#include "config.h"
+
+// -------- internal helpers --------
+// Device ids use '_' (e.g. synkro_res_p_beta), which is not valid in a
+// hostname label: map it to '-' and cap at the 63-char label limit.
+static void hostLabel(const char* deviceId, char* out, size_t cap) {
+  size_t n = 0;
+  for (; deviceId[n] && n + 1 < cap && n < 63; n++) {
+    out[n] = (deviceId[n] == '_') ? '-' : deviceId[n];
+  }
+  out[n] = '\0';
+}
+
+// -------- public API --------
+void mdns_advert::begin(const char* deviceId,
+                        const char* deviceName,
+                        uint16_t    port,
+                        const char* caps) {
+  if (!deviceId) return;
+
+  char host[64];
+  hostLabel(deviceId, host, sizeof(host));
+
+  if (!MDNS.begin(host)) {
+    Serial.println("[mDNS] Failed to start responder");
+    return;
+  }
+
+  MDNS.addService("synkro", "tcp", port);
+  MDNS.addServiceTxt("synkro", "tcp", "id",   deviceId);
+  MDNS.addServiceTxt("synkro", "tcp", "name", deviceName ? deviceName : "");
+  MDNS.addServiceTxt("synkro", "tcp", "fw",   FIRMWARE_VERSION);
+  MDNS.addServiceTxt("synkro", "tcp", "caps", caps ? caps : "");
+
+  Serial.print("[mDNS] Advertising _synkro._tcp as ");
+  Serial.print(host);
+  Serial.println(".local");
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+// mDNS / DNS-SD advertisement for Synkro panels (STA mode only).
+// Publishes:
+//  - hostname <deviceId>.local, with '_' mapped to '-'
+//    (synkro_res_p_beta → synkro-res-p-beta.local)
+//  - service _synkro._tcp on the shared web server port
+//    TXT: id, name, fw (FIRMWARE_VERSION), caps (comma-separated)
+//
+// Scanners browse _synkro._tcp instead of listening to a periodic
+// MQTT discovery stream; the MQTT discovery message is now only sent
+// (retained) on connect or when its content changes.
+
+namespace mdns_advert {
+
+  // Call once after STA is connected.
+  // caps: e.g. "light,metrics,ws"
+  void begin(const char* deviceId,
+             const char* deviceName,
+             uint16_t    port,
+             const char* caps);
+
+} // namespace mdns_advert
@@ -0,0 +1,191 @@
+// src/core/metrics.cpp
+#include "metrics.h"
+#include <WiFi.h>
+#include <ESPAsyncWebServer.h>
+#include "state_store.h"
+#include "loop_watchdog.h"
+#include "json_arena.h"
+
+// -------- statics --------
+static const char* sDeviceId = "";
+
+// Loop rate (computed over 1 s windows)
+static unsigned long  sWindowStart   = 0;
+static unsigned long  sLastTickUs    = 0;
+static uint32_t       sWindowLoops   = 0;
+static uint32_t       sWindowMaxUs   = 0;
+static uint32_t       sLoopHz        = 0;
+static uint32_t       sLoopMaxUs     = 0;   // worst loop time of last window
+static const unsigned long WINDOW_MS = 1000UL;
+
+// MQTT
+static uint32_t sMqttReconnects  = 0;
+static uint32_t sMqttRttMs       = 0;
+static uint32_t sMqttPublishOk   = 0;
+static uint32_t sMqttPublishFail = 0;
+static uint32_t sMqttReceived    = 0;
+
+// Control messages (MQTT + LAN)
+static uint32_t sCtrlAccepted    = 0;
+static uint32_t sCtrlRejected    = 0;
+static uint32_t sCtrlLastUs      = 0;
+static uint32_t sCtrlMaxUs       = 0;
+
+// -------- internal helpers --------
+static void appendMetric(String& out,
+                         const char* name,
+                         const char* type,
+                         const char* help,
+                         uint32_t value) {
+  out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+  out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+  out += name;
+  out += "{device=\""; out += sDeviceId; out += "\"} ";
+  out += value;
+  out += '\n';
+}
+
+static void appendMetricSigned(String& out,
+                               const char* name,
+                               const char* help,
+                               int32_t value) {
+  out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+  out += "# TYPE "; out += name; out += " gauge\n";
+  out += name;
+  out += "{device=\""; out += sDeviceId; out += "\"} ";
+  out += value;
+  out += '\n';
+}
+
+// -------- public API --------
+void metrics::begin(const char* deviceId) {
+  sDeviceId    = deviceId ? deviceId : "";
+  sWindowStart = millis();
+  sLastTickUs  = micros();
+}
+
+void metrics::attachHttp(AsyncWebServer& server) {
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest* req) {
+    String body;
+    metrics::renderPrometheus(body);
+    req->send(200, "text/plain; version=0.0.4", body);
+  });
+}
+
+void metrics::loopTick() {
+  unsigned long nowUs = micros();
+  uint32_t dtUs = nowUs - sLastTickUs;
+  sLastTickUs = nowUs;
+
+  sWindowLoops++;
+  if (dtUs > sWindowMaxUs) sWindowMaxUs = dtUs;
+
+  unsigned long now = millis();
+  unsigned long elapsed = now - sWindowStart;
+  if (elapsed >= WINDOW_MS) {
+    sLoopHz      = (uint32_t)((uint64_t)sWindowLoops * 1000UL / elapsed);
+    sLoopMaxUs   = sWindowMaxUs;
+    sWindowLoops = 0;
+    sWindowMaxUs = 0;
+    sWindowStart = now;
+  }
+}
+
+void metrics::countMqttReconnect() {
+  sMqttReconnects++;
+}
+
+void metrics::setMqttRtt(uint32_t ms) {
+  sMqttRttMs = ms;
+}
+
+void metrics::countPublish(bool ok) {
+  if (ok) sMqttPublishOk++;
+  else    sMqttPublishFail++;
+}
+
+void metrics::countReceive() {
+  sMqttReceived++;
+}
+
+void metrics::recordControl(uint32_t us, bool accepted) {
+  if (accepted) sCtrlAccepted++;
+  else          sCtrlRejected++;
+  sCtrlLastUs = us;
+  if (us > sCtrlMaxUs) sCtrlMaxUs = us;
+}
+
+void metrics::renderPrometheus(String& out) {
+  out.reserve(2048);
+
+  appendMetric(out, "synkro_uptime_seconds", "counter",
+               "Seconds since boot.", millis() / 1000);
+  appendMetric(out, "synkro_heap_free_bytes", "gauge",
+               "Current free heap.", ESP.getFreeHeap());
+  appendMetric(out, "synkro_heap_min_free_bytes", "gauge",
+               "Lowest free heap since boot.", ESP.getMinFreeHeap());
+  appendMetric(out, "synkro_heap_largest_block_bytes", "gauge",
+               "Largest allocatable heap block.", ESP.getMaxAllocHeap());
+  appendMetric(out, "synkro_loop_rate_hz", "gauge",
+               "Main loop iterations per second.", sLoopHz);
+  appendMetric(out, "synkro_loop_max_us", "gauge",
+               "Slowest main loop iteration in the last second.", sLoopMaxUs);
+  appendMetric(out, "synkro_loop_stalls_total", "counter",
+               "Loop stalls over the watchdog budget since power-on.", loop_watchdog::stallCount());
+  appendMetric(out, "synkro_mqtt_reconnects_total", "counter",
+               "Successful MQTT (re)connections.", sMqttReconnects);
+  appendMetric(out, "synkro_mqtt_rtt_ms", "gauge",
+               "Last broker round-trip time.", sMqttRttMs);
+  appendMetric(out, "synkro_mqtt_published_total", "counter",
+               "MQTT messages published.", sMqttPublishOk);
+  appendMetric(out, "synkro_mqtt_publish_failed_total", "counter",
+               "MQTT publishes that failed.", sMqttPublishFail);
+  appendMetric(out, "synkro_mqtt_received_total", "counter",
+               "MQTT messages received.", sMqttReceived);
+  appendMetric(out, "synkro_control_accepted_total", "counter",
+               "Control messages applied.", sCtrlAccepted);
+  appendMetric(out, "synkro_control_rejected_total", "counter",
+               "Control messages malformed, oversized or unknown.", sCtrlRejected);
+  appendMetric(out, "synkro_control_last_us", "gauge",
+               "Parse time of the last control message.", sCtrlLastUs);
+  appendMetric(out, "synkro_control_max_us", "gauge",
+               "Worst control message parse time since boot.", sCtrlMaxUs);
+  appendMetricSigned(out, "synkro_wifi_rssi_dbm",
+               "Wi-Fi signal strength.", WiFi.RSSI());
+  appendMetric(out, "synkro_nvs_writes_total", "counter",
+               "NVS state commits performed.", state_store::writesPerformed());
+  appendMetric(out, "synkro_nvs_writes_avoided_total", "counter",
+               "NVS state writes coalesced away.", state_store::writesAvoided());
+  appendMetric(out, "synkro_json_arena_bytes", "gauge",
+               "JSON arena capacity.", json_arena::capacity());
+  appendMetric(out, "synkro_json_arena_high_water_bytes", "gauge",
+               "Most JSON arena bytes in use at once.", json_arena::highWater());
+  appendMetric(out, "synkro_json_arena_overflows_total", "counter",
+               "JSON allocations that fell back to the heap.", json_arena::overflows());
+}
+
+void metrics::fillJson(JsonObject obj) {
+  obj["deviceId"]       = sDeviceId;
+  obj["uptime"]         = millis() / 1000;
+  obj["heapFree"]       = ESP.getFreeHeap();
+  obj["heapMinFree"]    = ESP.getMinFreeHeap();
+  obj["heapMaxBlock"]   = ESP.getMaxAllocHeap();
+  obj["loopHz"]         = sLoopHz;
+  obj["loopMaxUs"]      = sLoopMaxUs;
+  obj["loopStalls"]     = loop_watchdog::stallCount();
+  obj["mqttReconnects"] = sMqttReconnects;
+  obj["mqttRttMs"]      = sMqttRttMs;
+  obj["mqttPublished"]  = sMqttPublishOk;
+  obj["mqttPubFailed"]  = sMqttPublishFail;
+  obj["mqttReceived"]   = sMqttReceived;
+  obj["ctrlAccepted"]   = sCtrlAccepted;
+  obj["ctrlRejected"]   = sCtrlRejected;
+  obj["ctrlLastUs"]     = sCtrlLastUs;
+  obj["ctrlMaxUs"]      = sCtrlMaxUs;
+  obj["rssi"]           = WiFi.RSSI();
+  obj["nvsWrites"]      = state_store::writesPerformed();
+  obj["nvsAvoided"]     = state_store::writesAvoided();
+  obj["jsonArena"]      = json_arena::capacity();
+  obj["jsonArenaHigh"]  = json_arena::highWater();
+  obj["jsonArenaOvf"]   = json_arena::overflows();
+}
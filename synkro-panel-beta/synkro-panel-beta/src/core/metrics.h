@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class AsyncWebServer;
+
+// Health / resource metrics for Synkro panels.
+// Collects:
+//  - heap: free, minimum-ever free, largest free block
+//  - main loop rate and worst loop time (per 1 s window), stall count
+//  - MQTT reconnects, last broker round-trip time, publish/receive counters
+//  - control messages accepted / rejected, last and worst parse time
+//  - Wi-Fi RSSI
+//  - NVS writes performed / avoided (see state_store.h)
+//  - JSON arena size, high-water mark, heap overflows (see json_arena.h)
+//
+// Exposed as:
+//  - Prometheus text on GET http://<sta_ip>/metrics
+//  - JSON on synkro/devices/<ID>/metrics (mqtt_runtime, if METRICS_MQTT_ENABLED)
+//
+// Counters are plain 32-bit values written from the loop task and read
+// from the AsyncWebServer task; torn reads are not possible on ESP32.
+
+namespace metrics {
+
+  // deviceId: used as the "device" label
+  void begin(const char* deviceId);
+
+  // Register GET /metrics on the (STA) web server.
+  void attachHttp(AsyncWebServer& server);
+
+  // Call once per loop() pass, first thing.
+  void loopTick();
+
+  // MQTT hooks (called by mqtt_runtime / devices).
+  // RTT probes on .../ping are excluded from the publish/receive counts.
+  void countMqttReconnect();
+  void setMqttRtt(uint32_t ms);
+  void countPublish(bool ok);
+  void countReceive();
+
+  // One control message (MQTT or LAN): CPU time spent parsing it and
+  // whether it parsed into a known command.
+  void recordControl(uint32_t us, bool accepted);
+
+  // Prometheus text exposition format
+  void renderPrometheus(String& out);
+
+  // Same values as a flat JSON object
+  void fillJson(JsonObject obj);
+
+} // namespace metrics
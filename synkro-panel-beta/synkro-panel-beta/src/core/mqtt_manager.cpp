@@ -3,8 +3,13 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
+#include "json_arena.h"
 #include "devices/DeviceBase.h"
 #include "devices/LightingDevice.h"
+#include "config.h"
+#include "metrics.h"
+#include "control_protocol.h"
+#include "loop_watchdog.h"
 
 // -------- statics --------
 static const char* sDeviceId    = nullptr;
@@ -29,10 +34,24 @@ static const unsigned long RECONNECT_MS   = 5000UL;    // min 5 s between attemp
 static uint8_t        sFailCount          = 0;
 static const uint8_t  MAX_FAILS           = 5;
 
+// Broker round-trip probe: publish to our own ping topic, time the echo
+static unsigned long  sPingSentMs         = 0;
+static bool           sPingPending        = false;
+
+// Metrics topic (optional)
+static unsigned long  sLastMetrics        = 0;
+
+// Last discovery payload sent on this connection ("" → send on next check)
+static String         sLastDiscovery;
+
 // forward declarations
 static void ensureMqttConnectedNonBlocking();
 static void reportState();
 static void sendDiscovery();
+static void sendPing();
+static void publishMetrics();
+static void publishStall();
+static bool publish(const char* topic, const char* payload, bool retained = false);
 static void mqttCallback(char* topic, byte* payload, unsigned int length);
 
 static String wsUrlFromIp() {
@@ -70,6 +89,10 @@ void mqtt_runtime::begin(
   Device::setMqttClient(&sMqtt);
   sMqtt.setServer(sBrokerIp, sBrokerPort);
   sMqtt.setCallback(mqttCallback);
+  if (!sMqtt.setBufferSize(MQTT_BUFFER_SIZE)) {
+    // Still usable with the default 256 B buffer; large payloads will fail
+    Serial.println("[MQTT] Could not allocate packet buffer, keeping default");
+  }
 
   sLastConnectAttempt = 0;
   sFailCount          = 0;
@@ -85,14 +108,28 @@ void mqtt_runtime::loop() {
   ensureMqttConnectedNonBlocking();
 
   if (sMqtt.connected()) {
-    sMqtt.loop();
+    {
+      loop_watchdog::Scope phase(loop_watchdog::Phase::MqttLoop);
+      sMqtt.loop();
+    }
+
+    // A stall recorded earlier (or before a reboot) – report once
+    if (loop_watchdog::hasUnreported()) publishStall();
 
     unsigned long now = millis();
     if (now - sLastReport > REPORT_MS) {
       sLastReport = now;
       reportState();
-      sendDiscovery(); // keep discovery fresh for the scanner
+      sendDiscovery(); // only publishes if something (e.g. IP) changed
+      sendPing();
+    }
+
+#if METRICS_MQTT_ENABLED
+    if (now - sLastMetrics > METRICS_MQTT_MS) {
+      sLastMetrics = now;
+      publishMetrics();
     }
+#endif
   }
 }
 
@@ -103,24 +140,43 @@ void mqtt_runtime::notifyStateChanged() {
 
 // -------- internal helpers --------
 static void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  String msg;
-  msg.reserve(length + 1);
-  for (unsigned int i = 0; i < length; i++) {
-    msg += static_cast<char>(payload[i]);
+  if (!sDeviceId) return;
+
+  // Our own RTT probe coming back: no logging, just time it.
+  // Not counted as received traffic.
+  if (control_protocol::topicIs(topic, sDeviceId, "ping")) {
+    if (sPingPending) {
+      sPingPending = false;
+      metrics::setMqttRtt(millis() - sPingSentMs);
+    }
+    return;
   }
 
+  metrics::countReceive();
+
   Serial.print("[MQTT] Message on ");
   Serial.print(topic);
   Serial.print(": ");
-  Serial.println(msg);
+  if (length <= CONTROL_MAX_PAYLOAD) {
+    Serial.write(payload, length);
+    Serial.println();
+  } else {
+    Serial.print(length);
+    Serial.println(" bytes (too large, ignored)");
+  }
 
-  if (!sDeviceId || !sMainLight) return;
+  if (!sMainLight) return;
 
   // Global control topic: synkro/devices/<DEVICE_ID>/control
-  const String baseControl = String("synkro/devices/") + sDeviceId + "/control";
-  if (String(topic) == baseControl) {
+  if (control_protocol::topicIs(topic, sDeviceId, "control")) {
+    unsigned long t0 = micros();
+    control_protocol::Action action =
+      control_protocol::parse(reinterpret_cast<const char*>(payload), length);
+    metrics::recordControl(micros() - t0, action != control_protocol::Action::None);
+
     // For now we just have one controlled device
-    sMainLight->onMqttControl(msg);
+    sMainLight->applyControl(action);
+
     // Immediately push aggregate state for the web UI
     reportState();
   }
@@ -157,13 +213,17 @@ static void ensureMqttConnectedNonBlocking() {
   // LWT: synkro/devices/<ID>/lwt retained "offline"
   String lwtTopic = String("synkro/devices/") + sDeviceId + "/lwt";
 
-  bool ok = sMqtt.connect(
-    sDeviceId,
-    lwtTopic.c_str(), // will topic
-    1,                // QoS
-    true,             // retained
-    "offline"         // will payload
-  );
+  bool ok;
+  {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::MqttConnect);
+    ok = sMqtt.connect(
+      sDeviceId,
+      lwtTopic.c_str(), // will topic
+      1,                // QoS
+      true,             // retained
+      "offline"         // will payload
+    );
+  }
 
   if (!ok) {
     sFailCount++;
@@ -174,25 +234,34 @@ static void ensureMqttConnectedNonBlocking() {
 
   // Success: reset fail counter
   sFailCount = 0;
+  sPingPending = false;
+  metrics::countMqttReconnect();
   Serial.println("connected!");
 
   // Immediately publish ONLINE (retained) to the LWT topic
-  sMqtt.publish(lwtTopic.c_str(), "online", true);
+  publish(lwtTopic.c_str(), "online", true);
 
   // Subscribe to global control
   String controlTopic = String("synkro/devices/") + sDeviceId + "/control";
   sMqtt.subscribe(controlTopic.c_str());
   Serial.println("[MQTT] Subscribed to " + controlTopic);
 
+  // RTT probe echo
+  String pingTopic = String("synkro/devices/") + sDeviceId + "/ping";
+  sMqtt.subscribe(pingTopic.c_str());
+
   // Announce current state + discovery right away
+  sLastDiscovery = "";
   reportState();
   sendDiscovery();
 }
 
 static void reportState() {
   if (!sMqtt.connected() || !sDeviceId || !sDeviceName) return;
+  loop_watchdog::Scope phase(loop_watchdog::Phase::MqttReport);
 
-  StaticJsonDocument<256> state;
+  json_arena::Scope arena;
+  JsonDocument state(json_arena::allocator());
   state["deviceId"] = sDeviceId;
   state["name"]     = sDeviceName;
   state["uptime"]   = millis() / 1000;
@@ -211,10 +280,10 @@ static void reportState() {
 
   // Aggregate topic used by your web app
   String topicPerDevice = String("synkro/devices/") + sDeviceId + "/state";
-  sMqtt.publish(topicPerDevice.c_str(), msg.c_str());
+  publish(topicPerDevice.c_str(), msg.c_str());
 
   // Optional legacy global topic
-  sMqtt.publish("synkro/devices/state", msg.c_str());
+  publish("synkro/devices/state", msg.c_str());
 
   // Also publish per-device state (for future)
   if (sMainLight) {
@@ -226,18 +295,81 @@ static void reportState() {
 
 static void sendDiscovery() {
   if (!sMqtt.connected() || !sDeviceId || !sDeviceName) return;
+  loop_watchdog::Scope phase(loop_watchdog::Phase::MqttReport);
 
-  StaticJsonDocument<256> doc;
+  json_arena::Scope arena;
+  JsonDocument doc(json_arena::allocator());
   doc["id"]        = sDeviceId;
   doc["name"]      = sDeviceName;
   doc["ip"]        = WiFi.localIP().toString();
-  doc["status"]    = "online";
   doc["brokerUrl"] = wsUrlFromIp();
   if (mdnsHost().length()) doc["mdns"] = mdnsHost();
+  doc["fw"]        = FIRMWARE_VERSION;
+  doc["caps"]      = DEVICE_CAPS;
 
   String msg;
   serializeJson(doc, msg);
-  sMqtt.publish("synkro/discovery", msg.c_str());
 
-  Serial.println("[MQTT] Discovery sent: " + msg);
+  // Nothing changed since the last announcement on this connection
+  if (msg == sLastDiscovery) return;
+
+  // Retained per-device copy for late subscribers. It carries no "status":
+  // a retained "online" would outlive the panel (liveness is on .../lwt).
+  String topic = String("synkro/discovery/") + sDeviceId;
+  bool ok = publish(topic.c_str(), msg.c_str(), true);
+
+  // One-shot on the shared topic for scanners already listening; this one
+  // is only seen live, so it may still say "online".
+  doc["status"] = "online";
+  String live;
+  serializeJson(doc, live);
+  ok = publish("synkro/discovery", live.c_str()) && ok;
+  if (ok) sLastDiscovery = msg;
+
+  Serial.println("[MQTT] Discovery sent: " + live);
+}
+
+static void sendPing() {
+  if (!sMqtt.connected() || !sDeviceId) return;
+
+  // A probe that never came back leaves the last RTT as-is.
+  // Straight to the client: probes are not counted as published traffic.
+  String topic = String("synkro/devices/") + sDeviceId + "/ping";
+  sPingSentMs  = millis();
+  sPingPending = sMqtt.publish(topic.c_str(), "");
+}
+
+static void publishMetrics() {
+  if (!sMqtt.connected() || !sDeviceId) return;
+
+  json_arena::Scope arena;
+  JsonDocument doc(json_arena::allocator());
+  metrics::fillJson(doc.to<JsonObject>());
+
+  String msg;
+  serializeJson(doc, msg);
+
+  String topic = String("synkro/devices/") + sDeviceId + "/metrics";
+  publish(topic.c_str(), msg.c_str());
+}
+
+static void publishStall() {
+  if (!sMqtt.connected() || !sDeviceId) return;
+
+  json_arena::Scope arena;
+  JsonDocument doc(json_arena::allocator());
+  uint32_t stall = loop_watchdog::fillReport(doc.to<JsonObject>());
+
+  String msg;
+  serializeJson(doc, msg);
+
+  // Only a publish that went out counts; otherwise retry next pass
+  String topic = String("synkro/devices/") + sDeviceId + "/stall";
+  if (publish(topic.c_str(), msg.c_str())) loop_watchdog::markReported(stall);
+}
+
+static bool publish(const char* topic, const char* payload, bool retained) {
+  bool ok = sMqtt.publish(topic, payload, retained);
+  metrics::countPublish(ok);
+  return ok;
 }
\ No newline at end of file
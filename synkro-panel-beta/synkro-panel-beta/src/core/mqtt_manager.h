@@ -8,7 +8,8 @@ class LightingDevice;
 //  - MQTT connection & reconnection
 //  - LWT topic
 //  - aggregate state on synkro/devices/<ID>/state (with "light")
-//  - discovery on synkro/discovery
+//  - discovery on synkro/discovery (+ retained synkro/discovery/<ID>),
+//    sent on connect and when its content changes (see mdns_advert.h)
 //  - fanning control JSON to devices
 //  - OPTIONAL: dynamic broker IP updates via MQTT config topic
 //
@@ -49,7 +50,7 @@ namespace mqtt_runtime {
   // Handles:
   //  - reconnect if needed
   //  - mqtt.loop()
-  //  - periodic state + discovery publish
+  //  - periodic state publish (discovery only if changed)
   void loop();
 
   // Called when devices change state and we want instant aggregate update.
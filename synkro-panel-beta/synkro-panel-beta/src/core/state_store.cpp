@@ -0,0 +1,207 @@
+// src/core/state_store.cpp
+#include "state_store.h"
+#include <string.h>
+#include <stdio.h>
+#include "config.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Preferences.h>
+#endif
+
+// -------- statics --------
+static const char* sNamespace = "state";
+
+static const state_store::Backend* sBackend = nullptr;
+static state_store::Clock          sClock   = nullptr;
+
+// NVS keys are limited to 15 chars (+ NUL)
+static const size_t KEY_LEN     = 16;
+static const uint8_t MAX_KEYS   = 8;
+
+struct Entry {
+  char          key[KEY_LEN];
+  uint8_t       persisted;     // value currently in flash
+  uint8_t       pending;       // value requested by put()
+  bool          dirty;         // pending != persisted, not yet committed
+  uint32_t      lastCommitMs;
+};
+
+static Entry   sEntries[MAX_KEYS];
+static uint8_t sEntryCount = 0;
+
+static uint32_t sWritesPerformed = 0;
+static uint32_t sWritesAvoided   = 0;
+
+// -------- internal helpers --------
+#ifdef ARDUINO
+static Preferences sPrefs;
+
+static uint8_t nvsRead(const char* ns, const char* key, uint8_t def) {
+  sPrefs.begin(ns, true);   // read-only
+  uint8_t v = sPrefs.getUChar(key, def);
+  sPrefs.end();
+  return v;
+}
+
+static void nvsWrite(const char* ns, const char* key, uint8_t value) {
+  sPrefs.begin(ns, false);
+  sPrefs.putUChar(key, value);
+  sPrefs.end();
+}
+#else
+// No flash on the host: nothing persisted unless a backend is set
+static uint8_t nvsRead(const char*, const char*, uint8_t def) { return def; }
+static void nvsWrite(const char*, const char*, uint8_t) {}
+#endif
+
+static uint8_t readValue(const char* key, uint8_t def) {
+  return sBackend ? sBackend->read(sNamespace, key, def) : nvsRead(sNamespace, key, def);
+}
+
+static void writeValue(const char* key, uint8_t value) {
+  if (sBackend) sBackend->write(sNamespace, key, value);
+  else          nvsWrite(sNamespace, key, value);
+}
+
+static inline uint32_t nowMs() {
+  if (sClock) return sClock();
+#ifdef ARDUINO
+  return millis();
+#else
+  return 0;
+#endif
+}
+
+// Map any key to a valid NVS key (max 15 chars). Short keys are used as-is;
+// longer ones become <first 7 chars>~<7 hex of FNV-1a> so two long ids with
+// the same prefix don't collide. get() and commit() both use this result.
+static void nvsKey(const char* key, char out[KEY_LEN]) {
+  size_t len = strlen(key);
+  if (len < KEY_LEN) {
+    memcpy(out, key, len + 1);
+    return;
+  }
+
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<uint8_t>(key[i]);
+    h *= 16777619UL;
+  }
+  snprintf(out, KEY_LEN, "%.7s~%07lx", key, (unsigned long)(h & 0x0FFFFFFFUL));
+}
+
+static Entry* findEntry(const char* nkey) {
+  for (uint8_t i = 0; i < sEntryCount; i++) {
+    if (strcmp(sEntries[i].key, nkey) == 0) return &sEntries[i];
+  }
+  return nullptr;
+}
+
+static Entry* addEntry(const char* nkey, uint8_t persisted) {
+  if (sEntryCount >= MAX_KEYS) {
+#ifdef ARDUINO
+    Serial.print("[STATE] Too many keys, not persisting ");
+    Serial.println(nkey);
+#endif
+    return nullptr;
+  }
+  Entry& e = sEntries[sEntryCount++];
+  strcpy(e.key, nkey);   // already normalized by nvsKey()
+  e.persisted    = persisted;
+  e.pending      = persisted;
+  e.dirty        = false;
+  e.lastCommitMs = 0;
+  return &e;
+}
+
+static void commit(Entry& e, uint32_t now) {
+  writeValue(e.key, e.pending);
+
+  e.persisted    = e.pending;
+  e.dirty        = false;
+  e.lastCommitMs = now;
+  sWritesPerformed++;
+
+#ifdef ARDUINO
+  Serial.print("[STATE] Committed ");
+  Serial.print(e.key);
+  Serial.print("=");
+  Serial.println(e.persisted);
+#endif
+}
+
+// -------- public API --------
+void state_store::setBackend(const Backend* backend) {
+  sBackend = backend;
+}
+
+void state_store::setClock(Clock clock) {
+  sClock = clock;
+}
+
+void state_store::begin(const char* nvsNamespace) {
+  sNamespace       = nvsNamespace;
+  sEntryCount      = 0;
+  sWritesPerformed = 0;
+  sWritesAvoided   = 0;
+}
+
+uint8_t state_store::get(const char* key, uint8_t def) {
+  char nkey[KEY_LEN];
+  nvsKey(key, nkey);
+
+  Entry* e = findEntry(nkey);
+  if (e) return e->pending;
+
+  uint8_t v = readValue(nkey, def);
+  addEntry(nkey, v);
+  return v;
+}
+
+void state_store::put(const char* key, uint8_t value) {
+  char nkey[KEY_LEN];
+  nvsKey(key, nkey);
+
+  Entry* e = findEntry(nkey);
+  if (!e) {
+    // Unknown key: seed from flash first so we can compare.
+    // Default != value so a never-written key still gets committed.
+    get(key, value ^ 1);
+    e = findEntry(nkey);
+    if (!e) return;
+  }
+
+  // A pending value that gets replaced before commit never hits flash
+  if (e->dirty) sWritesAvoided++;
+
+  e->pending = value;
+  if (value == e->persisted) {
+    // Same as flash (a no-op, or cancelling the pending value): this put()
+    // never reaches flash either
+    e->dirty = false;
+    sWritesAvoided++;
+    return;
+  }
+  e->dirty = true;
+}
+
+void state_store::loop() {
+  uint32_t now = nowMs();
+  for (uint8_t i = 0; i < sEntryCount; i++) {
+    Entry& e = sEntries[i];
+    if (!e.dirty) continue;
+    if (e.lastCommitMs != 0 && now - e.lastCommitMs < STATE_COMMIT_MIN_MS) continue;
+    commit(e, now);
+    // One NVS commit per loop() pass keeps worst-case loop time bounded
+    return;
+  }
+}
+
+uint32_t state_store::writesPerformed() {
+  return sWritesPerformed;
+}
+
+uint32_t state_store::writesAvoided() {
+  return sWritesAvoided;
+}
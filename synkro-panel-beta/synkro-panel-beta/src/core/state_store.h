@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+
+// Small persisted-state helper for Synkro (NVS via Preferences).
+// Handles:
+//  - reading the last persisted value of a key at boot
+//  - coalescing writes: put() only marks the key dirty, loop() commits
+//  - at most one NVS commit per key every STATE_COMMIT_MIN_MS
+//  - skipping writes entirely when the value ends up unchanged
+//
+// Why coalesce?
+// -------------
+// Each put*/commit on NVS erases/programs flash and can take several ms.
+// A user hammering the wall button would otherwise wear flash and stall
+// loop() (and the button handling that depends on it) on every press.
+//
+// Everything here runs on the main loop task; there is no locking.
+//
+// No Arduino dependency outside #ifdef ARDUINO: with setBackend() and
+// setClock() the store runs on the host (test/test_state_store).
+
+namespace state_store {
+
+  // Where values live (default: NVS via Preferences).
+  struct Backend {
+    uint8_t (*read)(const char* nvsNamespace, const char* key, uint8_t def);
+    void    (*write)(const char* nvsNamespace, const char* key, uint8_t value);
+  };
+
+  // Returns the current time in ms (wraps like millis()).
+  using Clock = uint32_t (*)();
+
+  // Swap the backing store / time source (nullptr → NVS / millis()).
+  // Call before begin().
+  void setBackend(const Backend* backend);
+  void setClock(Clock clock);
+
+  // Open the namespace used for all keys (e.g. "state").
+  // Call once in setup() BEFORE devices restore their state.
+  // Forgets all cached keys and zeroes the counters.
+  void begin(const char* nvsNamespace);
+
+  // Keys may be any length (e.g. a device id); ids over the 15-char NVS
+  // limit are mapped to a stable short key internally.
+
+  // Read the persisted value of key, or def if it was never written.
+  // Also seeds the coalescing cache so an identical put() is free.
+  uint8_t get(const char* key, uint8_t def);
+
+  // Request key := value. Nothing touches flash here.
+  void put(const char* key, uint8_t value);
+
+  // Call in loop() regardless of Wi-Fi state.
+  // Commits dirty keys whose minimum interval has elapsed.
+  void loop();
+
+  // Counters (since begin()). Every put() ends up in exactly one of:
+  // performed, avoided, or still pending (at most one per key).
+  uint32_t writesPerformed();   // actual NVS commits
+  uint32_t writesAvoided();     // put() calls whose value never reached flash
+                                // (no-op, superseded, or cancelled)
+
+} // namespace state_store
@@ -4,6 +4,7 @@
 #include <ESPAsyncWebServer.h>
 #include <Preferences.h>
 #include <esp_system.h>
+#include "loop_watchdog.h"
 
 // --- statics (module-private) ---
 static AsyncWebServer sServer(80);
@@ -76,6 +77,8 @@ static void startProvisioningInternal() {
 }
 
 static void connectStaInternal() {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::WifiConnect);
+
     Serial.print("[WiFi] Connecting to ");
     Serial.println(sSsid);
 
@@ -101,6 +104,9 @@ static void connectStaInternal() {
         Serial.print("IP Address: ");
         Serial.println(WiFi.localIP());
         sProvisioning = false;
+
+        // STA endpoints (/metrics, ...) are registered by other modules
+        sServer.begin();
     } else {
         Serial.println("\n[WiFi] Failed to connect. Switching to provisioning mode.");
         startProvisioningInternal();
@@ -143,6 +149,10 @@ void wifi_portal::begin(const char* deviceId, const char* apSsid, const char* ap
     }
 }
 
+AsyncWebServer& wifi_portal::server() {
+    return sServer;
+}
+
 bool wifi_portal::isProvisioning() {
     return sProvisioning;
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+class AsyncWebServer;
+
 // Small Wi-Fi + provisioning helper for Synkro.
 // Encapsulates:
 //  - NVS credentials ("wifi" namespace: ssid, pass)
 //  - AP provisioning portal on http://<ap_ip>/
 //  - STA connection attempts
+//  - the shared HTTP server (port 80) for STA-mode endpoints (/metrics, ...)
 
 namespace wifi_portal {
 
@@ -24,6 +27,10 @@ namespace wifi_portal {
   // True if STA is connected to user Wi-Fi (and not in provisioning).
   bool isConnected();
 
+  // Shared web server. In STA mode it is started once connected;
+  // other modules register their routes on it after begin().
+  AsyncWebServer& server();
+
   // Optional hook, currently a no-op except for future extensibility.
   // Call this in loop() even if you don't strictly need it.
   void loop();
@@ -3,9 +3,10 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include "core/button_event.h"
 
 // Simple abstract base class for any controllable device
-class Device {
+class Device : public ButtonListener {
 public:
   Device(const String& id,
          const String& name,
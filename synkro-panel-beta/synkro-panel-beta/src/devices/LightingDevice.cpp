@@ -1,9 +1,13 @@
 // src/devices/LightingDevice.cpp
 #include "LightingDevice.h"
 #include <ArduinoJson.h>
+#include "core/json_arena.h"
 
 // Use the MQTT runtime helper (notifyMainStateChanged alias)
 #include "core/mqtt_manager.h"
+#include "core/state_store.h"
+#include "core/metrics.h"
+#include "core/input_scanner.h"
 
 LightingDevice::LightingDevice(
   const String& id,
@@ -19,38 +23,37 @@ LightingDevice::LightingDevice(
 // Setup
 // ----------------------------------------------------
 void LightingDevice::begin() {
-  // Logical default: lamp OFF
-  _on = false;
+  // Logical default: lamp OFF, unless we persist state and NVS says otherwise
+  _on = _persist ? (state_store::get(id().c_str(), 0) != 0) : false;
 
   pinMode(_relayPin, OUTPUT);
   // For your hardware (NPN optocoupler + NPN relay):
   // HIGH → lamp ON
   // LOW  → lamp OFF
-  digitalWrite(_relayPin, LOW);  // lamp OFF at boot
+  writeRelay();  // restored state (OFF when not persisting)
 
-  pinMode(_buttonPin, INPUT_PULLUP);
+  // Button is read + debounced by the shared scanner (INPUT_PULLUP there)
+  input_scanner::attach(_buttonPin, this);
 }
 
 // ----------------------------------------------------
 // Local physical handling
 // ----------------------------------------------------
 void LightingDevice::handle() {
-  // Simple button edge detect + debounce
-  static bool lastState = HIGH;
-  bool cur = digitalRead(_buttonPin);
-  unsigned long now = millis();
+  // Nothing periodic yet: the button arrives via onButton()
+  // from input_scanner::loop(), already debounced.
+}
 
-  if (lastState == HIGH && cur == LOW && (now - _lastButtonMs) > 300UL) {
-    _lastButtonMs = now;
+void LightingDevice::onButton(uint8_t pin, ButtonEvent ev) {
+  // Toggle on the press edge; release / long press are not used by a
+  // plain on/off light.
+  if (pin == _buttonPin && ev == ButtonEvent::Press) {
     toggle();
   }
-
-  lastState = cur;
 }
 
 void LightingDevice::toggle() {
-  _on = !_on;
-  writeRelay();
+  setRelay(!_on);
 
   // ❌ IMPORTANT: no MQTT call here.
   // Physical control must work even if Wi-Fi/MQTT/broker are dead.
@@ -58,14 +61,19 @@ void LightingDevice::toggle() {
 }
 
 void LightingDevice::setOn(bool v) {
-  _on = v;
-  writeRelay();
+  setRelay(v);
 
   // ✅ This one *is* allowed to touch MQTT,
   // because it's used when a command comes **from** the broker/UI.
   notifyMainStateChanged();  // alias → mqtt_runtime::notifyStateChanged()
 }
 
+void LightingDevice::setRelay(bool v) {
+  _on = v;
+  writeRelay();
+  persistState();
+}
+
 void LightingDevice::writeRelay() {
   // For YOUR hardware:
   //  _on == true  → lamp ON  → drive HIGH
@@ -73,32 +81,36 @@ void LightingDevice::writeRelay() {
   digitalWrite(_relayPin, _on ? HIGH : LOW);
 }
 
+void LightingDevice::persistState() {
+  // Only marks the key dirty; state_store::loop() does the flash write
+  if (_persist) state_store::put(id().c_str(), _on ? 1 : 0);
+}
+
 // ----------------------------------------------------
 // MQTT control & per-device state
 // ----------------------------------------------------
 void LightingDevice::onMqttControl(const String& json) {
   // expects {"action":"on"} | {"action":"off"} or {"toggle":true}
-  StaticJsonDocument<128> doc;
-  if (deserializeJson(doc, json)) return;
-
-  if (doc.containsKey("toggle") && doc["toggle"] == true) {
-    // This path is triggered by a "toggle" command from MQTT.
-    // It will end up calling setOn(...) (via onMqttControl) or just toggle(),
-    // and then we publish state (see setOn).
-    toggle();
-    // NOTE: toggle() no longer touches MQTT directly.
-    // The next periodic report will sync, or you can switch to setOn()
-    // if you want guaranteed immediate report even for "toggle".
-    return;
-  }
+  applyControl(control_protocol::parse(json.c_str(), json.length()));
+}
 
-  if (doc.containsKey("action")) {
-    String a = doc["action"].as<String>();
-    if (a == "on") {
-      setOn(true);   // this WILL publish MQTT state
-    } else if (a == "off") {
-      setOn(false);  // this WILL publish MQTT state
-    }
+void LightingDevice::applyControl(control_protocol::Action action) {
+  using control_protocol::Action;
+
+  // No MQTT here: the caller (mqtt_runtime / lan_control) reports state
+  // exactly once, after any faster path (LAN push) has been served.
+  switch (action) {
+    case Action::Toggle:
+      toggle();
+      break;
+    case Action::On:
+      setRelay(true);
+      break;
+    case Action::Off:
+      setRelay(false);
+      break;
+    case Action::None:
+      break;
   }
 }
 
@@ -110,7 +122,8 @@ void LightingDevice::publishState(const String& deviceIdRoot) {
   const String topic =
       "synkro/devices/" + deviceIdRoot + "/lighting/" + id() + "/state";
 
-  StaticJsonDocument<256> st;
+  json_arena::Scope arena;
+  JsonDocument st(json_arena::allocator());
   st["type"] = "lighting";
   st["room"] = room();
   st["name"] = name();
@@ -119,5 +132,5 @@ void LightingDevice::publishState(const String& deviceIdRoot) {
 
   String payload;
   serializeJson(st, payload);
-  mqtt()->publish(topic.c_str(), payload.c_str());
+  metrics::countPublish(mqtt()->publish(topic.c_str(), payload.c_str()));
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DeviceBase.h"
+#include "core/control_protocol.h"
 
 class LightingDevice : public Device {
 public:
@@ -12,18 +13,29 @@ public:
 
   void begin() override;
   void handle() override;
+  void onButton(uint8_t pin, ButtonEvent ev) override;
   void onMqttControl(const String& json) override;
   void publishState(const String& deviceIdRoot) override;
 
   bool isOn() const { return _on; }
   void setOn(bool v);
 
+  // Apply an already-parsed control command (MQTT or LAN).
+  // Does not report to MQTT; the caller does that once afterwards.
+  void applyControl(control_protocol::Action action);
+
+  // Restore the last relay state from NVS in begin() and persist changes
+  // (coalesced, see core/state_store.h). Call before begin().
+  void enablePersistence(bool enable) { _persist = enable; }
+
 private:
   void toggle();
+  void setRelay(bool v);   // relay + persistence, no MQTT
   void writeRelay();
+  void persistState();
 
   uint8_t _relayPin;
   uint8_t _buttonPin;
   bool    _on = false;
-  unsigned long _lastButtonMs = 0;
+  bool    _persist = false;
 };
\ No newline at end of file
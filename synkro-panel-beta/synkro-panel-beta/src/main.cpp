@@ -8,6 +8,12 @@
 #include "devices/LightingDevice.h"
 #include "core/wifi_manager.h"
 #include "core/mqtt_manager.h"
+#include "core/state_store.h"
+#include "core/metrics.h"
+#include "core/lan_control.h"
+#include "core/input_scanner.h"
+#include "core/mdns_advert.h"
+#include "core/loop_watchdog.h"
 
 
 // ------------------ DEVICES ------------------
@@ -28,14 +34,31 @@ void setup() {
   delay(800);
   Serial.println("\n[Booting FireBeetle 2 ESP32-E]");
 
+  // Stall watchdog first: logs a record left by the previous boot.
+  // Armed from here (with the longer LOOP_STALL_SETUP_MS budget), so a
+  // Wi-Fi connect that hangs below is recorded too.
+  loop_watchdog::begin(LOOP_STALL_BUDGET_MS);
+
+  // Persisted state (relay restore) – before Wi-Fi so lights come back ASAP
+  state_store::begin("state");
+  mainRoomLight.enablePersistence(PERSIST_RELAY_STATE);
+
   // Local IO
   mainRoomLight.begin();
 
   // Wi-Fi + provisioning
   wifi_portal::begin(DEVICE_ID, AP_SSID, AP_PASS);
 
-  // If we managed to connect STA, initialize MQTT runtime
+  // Health metrics (loop rate is tracked in every mode)
+  metrics::begin(DEVICE_ID);
+
+  // If we managed to connect STA, expose metrics and initialize MQTT runtime
   if (wifi_portal::isConnected()) {
+    metrics::attachHttp(wifi_portal::server());
+
+    // DNS-SD: _synkro._tcp on the web server port
+    mdns_advert::begin(DEVICE_ID, DEVICE_NAME, 80, DEVICE_CAPS);
+
     mqtt_runtime::begin(
       DEVICE_ID,
       DEVICE_NAME,
@@ -44,16 +67,39 @@ void setup() {
       BROKER_MDNS,
       &mainRoomLight
     );
+
+    // Direct LAN control – works even when the broker is unreachable
+    lan_control::begin(
+      wifi_portal::server(),
+      DEVICE_ID,
+      LAN_CONTROL_TOKEN,
+      &mainRoomLight
+    );
   }
 }
 
 void loop() {
+  // One pass completed since the last call → heartbeat
+  loop_watchdog::feed();
+  metrics::loopTick();
+
   // Physical local control should ALWAYS work,
   // even if Wi-Fi / MQTT / broker are offline.
-  mainRoomLight.handle();
+  {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::Input);
+    input_scanner::loop();   // one bank read → debounced button events
+    mainRoomLight.handle();
+  }
+
+  // Coalesced NVS writes (cheap no-op when nothing is dirty)
+  {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::StateStore);
+    state_store::loop();
+  }
 
   // If we are in provisioning AP mode, just keep the portal alive.
   if (wifi_portal::isProvisioning()) {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::Provisioning);
     wifi_portal::loop();
     delay(50);
     return;
@@ -66,6 +112,10 @@ void loop() {
     return;
   }
 
-  // Wi-Fi is up → keep MQTT runtime going
+  // Wi-Fi is up → LAN clients first (single hop), then MQTT runtime
+  {
+    loop_watchdog::Scope phase(loop_watchdog::Phase::LanControl);
+    lan_control::loop();
+  }
   mqtt_runtime::loop();
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+// test/fuzz/fuzz_control_parse.cpp
+// libFuzzer target for the untrusted-input paths of core/control_protocol.
+// Not a PlatformIO test suite (no test_ prefix); build it by hand with clang
+// (run "pio test -e native" once first so ArduinoJson is in .pio/libdeps):
+/*
+    clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined \
+      -I src -I .pio/libdeps/native/ArduinoJson/src \
+      test/fuzz/fuzz_control_parse.cpp \
+      src/core/control_protocol.cpp src/core/json_arena.cpp \
+      -o fuzz_control_parse
+    ./fuzz_control_parse -max_len=512
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "core/control_protocol.h"
+#include "core/json_arena.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  // 1. Raw broker / WebSocket payload (not NUL-terminated)
+  control_protocol::parse(reinterpret_cast<const char*>(data), size);
+
+  // Control payloads are capped well below the arena size, so parsing
+  // must never fall back to the heap.
+  if (json_arena::overflows() != 0) __builtin_trap();
+
+  // 2. Topic matching: first byte splits the input into topic / device id
+  if (size > 0) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    size_t split = 1 + data[0] % size;          // 1..size
+    std::string topic(bytes + 1, split - 1);    // data[1, split)
+    std::string id(bytes + split, size - split); // data[split, size)
+    control_protocol::topicIs(topic.c_str(), id.c_str(), "control");
+
+    // 3. State serialization with an arbitrary device id
+    char out[96];
+    size_t n = control_protocol::writeLightState(out, sizeof(out), id.c_str(), size & 1);
+    if (n >= sizeof(out) || (n && strlen(out) != n)) __builtin_trap();
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+// test/test_bench_control/test_main.cpp
+// Host microbenchmarks for control parsing / state serialization
+// (pio test -e native -f test_bench_control -v to see the numbers).
+//
+// Reports ns/message and allocations/message, once with the shared
+// json_arena and once with plain malloc (what a bare v7 JsonDocument does),
+// through a counting ArduinoJson::Allocator.
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "core/control_protocol.h"
+#include "core/json_arena.h"
+
+static const int ITERATIONS = 20000;
+
+// Counts every call, then forwards to the real allocator
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+  explicit CountingAllocator(ArduinoJson::Allocator* base) : _base(base) {}
+
+  void* allocate(size_t size) override {
+    allocs++;
+    bytes += size;
+    return _base->allocate(size);
+  }
+  void deallocate(void* ptr) override {
+    if (ptr) frees++;
+    _base->deallocate(ptr);
+  }
+  void* reallocate(void* ptr, size_t size) override {
+    reallocs++;
+    return _base->reallocate(ptr, size);
+  }
+
+  void reset() { allocs = frees = reallocs = 0; bytes = 0; }
+
+  uint64_t allocs   = 0;
+  uint64_t frees    = 0;
+  uint64_t reallocs = 0;
+  uint64_t bytes    = 0;
+
+private:
+  ArduinoJson::Allocator* _base;
+};
+
+class MallocAllocator : public ArduinoJson::Allocator {
+public:
+  void* allocate(size_t size) override { return malloc(size); }
+  void deallocate(void* ptr) override { free(ptr); }
+  void* reallocate(void* ptr, size_t size) override { return realloc(ptr, size); }
+};
+
+struct Sample {
+  const char* name;
+  const char* json;
+};
+
+static const Sample SAMPLES[] = {
+  { "action_on",  "{\"action\":\"on\"}" },
+  { "toggle",     "{\"toggle\":true}" },
+  { "extra_keys", "{\"action\":\"off\",\"source\":\"web-ui\",\"user\":\"admin\",\"ts\":1700000000}" },
+  { "malformed",  "{\"action\":\"on\"" },
+  { "too_deep",   "{\"x\":[[[[[[[[1]]]]]]]]}" },
+};
+
+static MallocAllocator sMalloc;
+
+static void report(const char* path, const char* name, double ns, const CountingAllocator& c) {
+  char line[160];
+  snprintf(line, sizeof(line),
+           "%-6s %-10s %8.1f ns/msg  %5.2f alloc/msg  %5.2f realloc/msg  %7.1f B/msg",
+           path, name, ns,
+           (double)c.allocs / ITERATIONS,
+           (double)c.reallocs / ITERATIONS,
+           (double)c.bytes / ITERATIONS);
+  TEST_MESSAGE(line);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void bench_parse_arena() {
+  CountingAllocator counting(json_arena::allocator());
+  uint32_t overflowsBefore = json_arena::overflows();
+
+  for (const Sample& s : SAMPLES) {
+    const size_t len = strlen(s.json);
+    counting.reset();
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+      json_arena::Scope arena;
+      control_protocol::parse(s.json, len, &counting);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+    report("arena", s.name, ns, counting);
+  }
+
+  // The whole point of the arena: nothing reaches the general heap
+  TEST_ASSERT_EQUAL_UINT32(overflowsBefore, json_arena::overflows());
+}
+
+static void bench_parse_heap() {
+  CountingAllocator counting(&sMalloc);
+
+  for (const Sample& s : SAMPLES) {
+    const size_t len = strlen(s.json);
+    counting.reset();
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+      control_protocol::parse(s.json, len, &counting);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+    report("heap", s.name, ns, counting);
+
+    // No leaks: every heap block is given back
+    TEST_ASSERT_TRUE(counting.allocs == counting.frees);
+  }
+}
+
+static void bench_write_light_state() {
+  char buf[96];
+  uint32_t overflowsBefore = json_arena::overflows();
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    control_protocol::writeLightState(buf, sizeof(buf), "synkro_res_p_beta", i & 1);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+  char line[96];
+  snprintf(line, sizeof(line), "arena  state      %8.1f ns/msg  (arena high-water %u B)",
+           ns, (unsigned)json_arena::highWater());
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL_UINT32(overflowsBefore, json_arena::overflows());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(bench_parse_arena);
+  RUN_TEST(bench_parse_heap);
+  RUN_TEST(bench_write_light_state);
+  return UNITY_END();
+}
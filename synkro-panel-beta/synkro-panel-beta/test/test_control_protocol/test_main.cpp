@@ -0,0 +1,148 @@
+// test/test_control_protocol/test_main.cpp
+// Host tests for core/control_protocol (pio test -e native)
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "core/control_protocol.h"
+#include "core/json_arena.h"
+#include "core/config.h"
+
+using control_protocol::Action;
+
+static Action parseStr(const char* s) {
+  return control_protocol::parse(s, strlen(s));
+}
+
+void setUp() {}
+void tearDown() {}
+
+// -------- parse() --------
+static void test_parse_actions() {
+  TEST_ASSERT_EQUAL(Action::On,     parseStr("{\"action\":\"on\"}"));
+  TEST_ASSERT_EQUAL(Action::Off,    parseStr("{\"action\":\"off\"}"));
+  TEST_ASSERT_EQUAL(Action::Toggle, parseStr("{\"toggle\":true}"));
+}
+
+static void test_parse_toggle_precedence() {
+  // toggle:true wins, toggle:false falls through to action
+  TEST_ASSERT_EQUAL(Action::Toggle, parseStr("{\"action\":\"off\",\"toggle\":true}"));
+  TEST_ASSERT_EQUAL(Action::On,     parseStr("{\"toggle\":false,\"action\":\"on\"}"));
+  TEST_ASSERT_EQUAL(Action::None,   parseStr("{\"toggle\":false}"));
+  TEST_ASSERT_EQUAL(Action::None,   parseStr("{\"toggle\":1}"));
+  TEST_ASSERT_EQUAL(Action::None,   parseStr("{\"toggle\":\"true\"}"));
+}
+
+static void test_parse_unknown_and_wrong_types() {
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"action\":\"ON\"}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"action\":\"dim\"}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"action\":1}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"action\":null}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("[\"on\"]"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("\"on\""));
+}
+
+static void test_parse_malformed() {
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"action\":\"on\""));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{action:on"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("\xff\xfe\x00"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr(""));
+  TEST_ASSERT_EQUAL(Action::None, control_protocol::parse(nullptr, 10));
+  TEST_ASSERT_EQUAL(Action::None, control_protocol::parse("{}", 0));
+}
+
+static void test_parse_nesting_limited() {
+  TEST_ASSERT_EQUAL(Action::None, parseStr("{\"x\":[[[\"on\"]]],\"action\":\"on\"}"));
+  TEST_ASSERT_EQUAL(Action::None, parseStr("[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]"));
+}
+
+static void test_parse_size_limit() {
+  // Valid JSON padded with whitespace to exactly the limit → accepted
+  std::string ok = "{\"action\":\"on\"}";
+  ok.append(CONTROL_MAX_PAYLOAD - ok.size(), ' ');
+  TEST_ASSERT_EQUAL(Action::On, control_protocol::parse(ok.data(), ok.size()));
+
+  // One byte over → rejected without parsing
+  std::string big = ok + " ";
+  TEST_ASSERT_EQUAL(Action::None, control_protocol::parse(big.data(), big.size()));
+}
+
+static void test_parse_respects_length() {
+  // Not NUL-terminated: only the first len bytes count
+  const char buf[] = "{\"action\":\"off\"}{\"action\":\"on\"}";
+  TEST_ASSERT_EQUAL(Action::Off, control_protocol::parse(buf, 16));
+  TEST_ASSERT_EQUAL(Action::None, control_protocol::parse(buf, 10));
+}
+
+static void test_parse_stays_in_arena() {
+  uint32_t before = json_arena::overflows();
+  for (int i = 0; i < 100; i++) parseStr("{\"action\":\"on\",\"extra\":\"ignored\"}");
+  TEST_ASSERT_EQUAL_UINT32(before, json_arena::overflows());
+}
+
+// -------- topicIs() --------
+static void test_topic_matches() {
+  TEST_ASSERT_TRUE(control_protocol::topicIs("synkro/devices/dev1/control", "dev1", "control"));
+  TEST_ASSERT_TRUE(control_protocol::topicIs("synkro/devices/dev1/ping", "dev1", "ping"));
+}
+
+static void test_topic_rejects() {
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/control", "dev2", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev10/control", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev/control", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/controls", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/control/x", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1control", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/device/dev1/control", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("", "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs(nullptr, "dev1", "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/control", nullptr, "control"));
+  TEST_ASSERT_FALSE(control_protocol::topicIs("synkro/devices/dev1/control", "dev1", nullptr));
+}
+
+// -------- writeLightState() --------
+static void test_write_light_state() {
+  char buf[96];
+  size_t n = control_protocol::writeLightState(buf, sizeof(buf), "dev1", true);
+  TEST_ASSERT_EQUAL_STRING("{\"deviceId\":\"dev1\",\"light\":\"on\"}", buf);
+  TEST_ASSERT_EQUAL(strlen(buf), n);
+
+  control_protocol::writeLightState(buf, sizeof(buf), "dev1", false);
+  TEST_ASSERT_EQUAL_STRING("{\"deviceId\":\"dev1\",\"light\":\"off\"}", buf);
+}
+
+static void test_write_light_state_escapes() {
+  char buf[96];
+  control_protocol::writeLightState(buf, sizeof(buf), "a\"b", true);
+  TEST_ASSERT_EQUAL_STRING("{\"deviceId\":\"a\\\"b\",\"light\":\"on\"}", buf);
+}
+
+static void test_write_light_state_capacity() {
+  const char* expected = "{\"deviceId\":\"dev1\",\"light\":\"on\"}";
+  const size_t len = strlen(expected);
+  char buf[96];
+
+  // Exact fit (payload + NUL) works, one byte less reports 0
+  TEST_ASSERT_EQUAL(len, control_protocol::writeLightState(buf, len + 1, "dev1", true));
+  TEST_ASSERT_EQUAL(0, control_protocol::writeLightState(buf, len, "dev1", true));
+  TEST_ASSERT_EQUAL(0, control_protocol::writeLightState(nullptr, 0, "dev1", true));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_actions);
+  RUN_TEST(test_parse_toggle_precedence);
+  RUN_TEST(test_parse_unknown_and_wrong_types);
+  RUN_TEST(test_parse_malformed);
+  RUN_TEST(test_parse_nesting_limited);
+  RUN_TEST(test_parse_size_limit);
+  RUN_TEST(test_parse_respects_length);
+  RUN_TEST(test_parse_stays_in_arena);
+  RUN_TEST(test_topic_matches);
+  RUN_TEST(test_topic_rejects);
+  RUN_TEST(test_write_light_state);
+  RUN_TEST(test_write_light_state_escapes);
+  RUN_TEST(test_write_light_state_capacity);
+  return UNITY_END();
+}
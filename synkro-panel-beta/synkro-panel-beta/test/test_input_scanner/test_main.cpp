@@ -0,0 +1,219 @@
+// test/test_input_scanner/test_main.cpp
+// Host tests for core/input_scanner over a simulated pin bank and clock
+// (pio test -e native -f test_input_scanner)
+#include <unity.h>
+#include <stdint.h>
+#include "core/input_scanner.h"
+#include "core/config.h"
+
+// -------- simulated bank / clock --------
+static const uint8_t PIN_A = 3;
+static const uint8_t PIN_B = 40;       // above 32: exercises the high word
+
+static uint64_t sBank = ~0ULL;         // all HIGH = all released (pull-ups)
+static uint32_t sNow  = 0;
+
+static uint64_t readBank() { return sBank; }
+static uint32_t clockMs()  { return sNow; }
+
+static void setPressed(uint8_t pin, bool pressed) {
+  if (pressed) sBank &= ~(1ULL << pin);   // active-LOW
+  else         sBank |=  (1ULL << pin);
+}
+
+// Advance to the next scan slot and run n scans
+static void scan(int n = 1) {
+  for (int i = 0; i < n; i++) {
+    sNow += INPUT_SCAN_MS;
+    input_scanner::loop();
+  }
+}
+
+// -------- recording listener --------
+class Recorder : public ButtonListener {
+public:
+  void onButton(uint8_t pin, ButtonEvent ev) override {
+    lastPin = pin;
+    if (ev == ButtonEvent::Press)     presses++;
+    if (ev == ButtonEvent::Release)   releases++;
+    if (ev == ButtonEvent::LongPress) longPresses++;
+  }
+
+  int     presses     = 0;
+  int     releases    = 0;
+  int     longPresses = 0;
+  uint8_t lastPin     = 0xFF;
+};
+
+static Recorder sRec;
+
+void setUp() {
+  input_scanner::reset();
+  sBank = ~0ULL;
+  sNow  = 1000;
+  sRec  = Recorder();
+  input_scanner::setPinReader(readBank);
+  input_scanner::setClock(clockMs);
+  input_scanner::attach(PIN_A, &sRec);
+}
+
+void tearDown() {}
+
+// Seed with the current bank (first loop() only takes the boot snapshot)
+static void boot() {
+  input_scanner::loop();
+}
+
+// -------- debounce --------
+static void test_press_needs_four_stable_scans() {
+  boot();
+  setPressed(PIN_A, true);
+
+  scan(3);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+
+  scan();
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+  TEST_ASSERT_EQUAL(PIN_A, sRec.lastPin);
+
+  // Staying pressed does not repeat the event
+  scan(10);
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+}
+
+static void test_bounce_restarts_count() {
+  boot();
+
+  // Three low samples then a high one: counter resets, no press
+  setPressed(PIN_A, true);
+  scan(3);
+  setPressed(PIN_A, false);
+  scan();
+  setPressed(PIN_A, true);
+  scan(3);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+
+  scan();
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+}
+
+static void test_release_needs_four_stable_scans() {
+  boot();
+  setPressed(PIN_A, true);
+  scan(4);
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+
+  setPressed(PIN_A, false);
+  scan(3);
+  TEST_ASSERT_EQUAL(0, sRec.releases);
+  scan();
+  TEST_ASSERT_EQUAL(1, sRec.releases);
+}
+
+static void test_samples_at_most_once_per_interval() {
+  boot();
+  setPressed(PIN_A, true);
+
+  // Many loop() passes without the clock moving: still only one sample
+  sNow += INPUT_SCAN_MS;
+  for (int i = 0; i < 20; i++) input_scanner::loop();
+  scan(2);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+
+  scan();
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+}
+
+// -------- boot --------
+static void test_held_at_boot_is_not_a_press() {
+  setPressed(PIN_A, true);
+  boot();
+
+  scan(LONG_PRESS_MS / INPUT_SCAN_MS + 10);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+  TEST_ASSERT_EQUAL(0, sRec.longPresses);
+
+  // Letting go: no Release for a Press that was never sent
+  setPressed(PIN_A, false);
+  scan(4);
+  TEST_ASSERT_EQUAL(0, sRec.releases);
+
+  // A real press after letting go is reported normally, and so is its release
+  setPressed(PIN_A, true);
+  scan(4);
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+  setPressed(PIN_A, false);
+  scan(4);
+  TEST_ASSERT_EQUAL(1, sRec.releases);
+}
+
+// -------- long press --------
+static void test_long_press_fires_once() {
+  boot();
+  setPressed(PIN_A, true);
+  scan(4);                              // Press at sNow
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+
+  const uint32_t pressedAt = sNow;
+  while (sNow - pressedAt + INPUT_SCAN_MS < LONG_PRESS_MS) scan();
+  TEST_ASSERT_EQUAL(0, sRec.longPresses);
+
+  scan();                               // crosses LONG_PRESS_MS
+  TEST_ASSERT_EQUAL(1, sRec.longPresses);
+
+  scan(LONG_PRESS_MS / INPUT_SCAN_MS * 2);
+  TEST_ASSERT_EQUAL(1, sRec.longPresses);
+
+  // Next press arms it again
+  setPressed(PIN_A, false);
+  scan(4);
+  setPressed(PIN_A, true);
+  scan(4 + LONG_PRESS_MS / INPUT_SCAN_MS);
+  TEST_ASSERT_EQUAL(2, sRec.presses);
+  TEST_ASSERT_EQUAL(2, sRec.longPresses);
+}
+
+static void test_short_press_has_no_long_press() {
+  boot();
+  setPressed(PIN_A, true);
+  scan(4);
+  setPressed(PIN_A, false);
+  scan(LONG_PRESS_MS / INPUT_SCAN_MS * 2);
+  TEST_ASSERT_EQUAL(1, sRec.presses);
+  TEST_ASSERT_EQUAL(1, sRec.releases);
+  TEST_ASSERT_EQUAL(0, sRec.longPresses);
+}
+
+// -------- bank --------
+static void test_unattached_pins_are_ignored() {
+  boot();
+  setPressed(7, true);
+  scan(10);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+}
+
+static void test_high_bank_pin() {
+  Recorder other;
+  input_scanner::attach(PIN_B, &other);
+  boot();
+
+  setPressed(PIN_B, true);
+  scan(4);
+  TEST_ASSERT_EQUAL(1, other.presses);
+  TEST_ASSERT_EQUAL(PIN_B, other.lastPin);
+  TEST_ASSERT_EQUAL(0, sRec.presses);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_press_needs_four_stable_scans);
+  RUN_TEST(test_bounce_restarts_count);
+  RUN_TEST(test_release_needs_four_stable_scans);
+  RUN_TEST(test_samples_at_most_once_per_interval);
+  RUN_TEST(test_held_at_boot_is_not_a_press);
+  RUN_TEST(test_long_press_fires_once);
+  RUN_TEST(test_short_press_has_no_long_press);
+  RUN_TEST(test_unattached_pins_are_ignored);
+  RUN_TEST(test_high_bank_pin);
+  return UNITY_END();
+}
@@ -0,0 +1,202 @@
+// test/test_state_store/test_main.cpp
+// Host tests for core/state_store over a fake NVS and clock
+// (pio test -e native -f test_state_store)
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include "core/state_store.h"
+#include "core/config.h"
+
+// -------- fake NVS / clock --------
+static std::map<std::string, uint8_t> sFlash;   // "<ns>/<key>" → value
+static uint32_t    sFlashWrites = 0;
+static std::string sLastKey;
+static uint32_t    sNow = 0;
+
+static uint8_t fakeRead(const char* ns, const char* key, uint8_t def) {
+  sLastKey = key;
+  auto it = sFlash.find(std::string(ns) + "/" + key);
+  return it == sFlash.end() ? def : it->second;
+}
+
+static void fakeWrite(const char* ns, const char* key, uint8_t value) {
+  sLastKey = key;
+  sFlash[std::string(ns) + "/" + key] = value;
+  sFlashWrites++;
+}
+
+static uint32_t clockMs() { return sNow; }
+
+static const state_store::Backend FAKE_NVS = { fakeRead, fakeWrite };
+
+static uint8_t flashValue(const char* key) {
+  return sFlash[std::string("state/") + key];
+}
+
+// Let the per-key minimum interval pass, then run one loop() pass
+static void afterInterval() {
+  sNow += STATE_COMMIT_MIN_MS;
+  state_store::loop();
+}
+
+void setUp() {
+  sFlash.clear();
+  sFlashWrites = 0;
+  sLastKey.clear();
+  sNow = 1000;
+  state_store::setBackend(&FAKE_NVS);
+  state_store::setClock(clockMs);
+  state_store::begin("state");
+}
+
+void tearDown() {}
+
+// -------- get() --------
+static void test_get_reads_flash_or_default() {
+  sFlash["state/lamp"] = 1;
+  TEST_ASSERT_EQUAL(1, state_store::get("lamp", 0));
+  TEST_ASSERT_EQUAL(7, state_store::get("other", 7));
+  TEST_ASSERT_EQUAL(0, sFlashWrites);
+}
+
+static void test_put_same_as_get_is_free() {
+  sFlash["state/lamp"] = 1;
+  state_store::get("lamp", 0);
+  state_store::put("lamp", 1);
+  afterInterval();
+  TEST_ASSERT_EQUAL(0, sFlashWrites);
+  TEST_ASSERT_EQUAL_UINT32(0, state_store::writesPerformed());
+  TEST_ASSERT_EQUAL_UINT32(1, state_store::writesAvoided());
+}
+
+static void test_never_written_key_is_committed() {
+  state_store::put("fresh", 0);
+  state_store::loop();
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+  TEST_ASSERT_EQUAL(0, flashValue("fresh"));
+}
+
+// -------- coalescing --------
+static void test_burst_coalesces_to_one_commit() {
+  state_store::get("lamp", 0);
+  state_store::put("lamp", 1);
+  state_store::loop();                 // first commit is immediate
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+
+  // Hammering the button inside the interval: nothing reaches flash
+  for (int i = 0; i < 9; i++) state_store::put("lamp", i & 1);
+  state_store::loop();
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+
+  afterInterval();
+  TEST_ASSERT_EQUAL(2, sFlashWrites);
+  TEST_ASSERT_EQUAL(0, flashValue("lamp"));   // last put wins
+
+  TEST_ASSERT_EQUAL_UINT32(2, state_store::writesPerformed());
+  TEST_ASSERT_EQUAL_UINT32(8, state_store::writesAvoided());
+}
+
+static void test_cancelled_pending_counts_both_puts() {
+  state_store::get("lamp", 0);
+  state_store::put("lamp", 1);
+  state_store::loop();
+  uint32_t avoided = state_store::writesAvoided();
+
+  // put(0) then put(1) back to flash's value: neither reaches flash
+  sNow += 10;
+  state_store::put("lamp", 0);
+  state_store::put("lamp", 1);
+  afterInterval();
+
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+  TEST_ASSERT_EQUAL_UINT32(avoided + 2, state_store::writesAvoided());
+}
+
+static void test_counters_account_for_every_put() {
+  state_store::get("a", 0);
+  state_store::get("b", 0);
+
+  uint32_t puts = 0;
+  uint32_t seed = 12345;
+  for (int i = 0; i < 500; i++) {
+    seed = seed * 1103515245UL + 12345UL;
+    state_store::put((seed >> 8) & 1 ? "a" : "b", (seed >> 16) & 1);
+    puts++;
+    sNow += (seed >> 20) % 400;
+    state_store::loop();
+  }
+
+  // Drain: everything still pending gets committed
+  afterInterval();
+  afterInterval();
+
+  TEST_ASSERT_EQUAL_UINT32(puts, state_store::writesPerformed() + state_store::writesAvoided());
+  TEST_ASSERT_EQUAL_UINT32(sFlashWrites, state_store::writesPerformed());
+}
+
+// -------- scheduling --------
+static void test_min_interval_per_key() {
+  state_store::get("lamp", 0);
+  state_store::put("lamp", 1);
+  state_store::loop();
+
+  state_store::put("lamp", 0);
+  sNow += STATE_COMMIT_MIN_MS - 1;
+  state_store::loop();
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+
+  sNow += 1;
+  state_store::loop();
+  TEST_ASSERT_EQUAL(2, sFlashWrites);
+}
+
+static void test_one_commit_per_loop_pass() {
+  state_store::put("a", 1);
+  state_store::put("b", 1);
+  state_store::loop();
+  TEST_ASSERT_EQUAL(1, sFlashWrites);
+  state_store::loop();
+  TEST_ASSERT_EQUAL(2, sFlashWrites);
+}
+
+// -------- keys --------
+static void test_long_key_same_for_read_and_write() {
+  const char* id = "synkro_res_p_beta_main_light";
+  state_store::get(id, 0);
+  std::string readKey = sLastKey;
+
+  state_store::put(id, 1);
+  state_store::loop();
+  TEST_ASSERT_EQUAL_STRING(readKey.c_str(), sLastKey.c_str());
+  TEST_ASSERT_TRUE(readKey.size() <= 15);
+
+  // Survives a "reboot"
+  state_store::begin("state");
+  TEST_ASSERT_EQUAL(1, state_store::get(id, 0));
+}
+
+static void test_long_keys_with_same_prefix_differ() {
+  state_store::put("synkro_res_p_beta_a", 1);
+  state_store::loop();
+  std::string a = sLastKey;
+  state_store::put("synkro_res_p_beta_b", 1);
+  state_store::loop();
+  TEST_ASSERT_TRUE(a != sLastKey);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_get_reads_flash_or_default);
+  RUN_TEST(test_put_same_as_get_is_free);
+  RUN_TEST(test_never_written_key_is_committed);
+  RUN_TEST(test_burst_coalesces_to_one_commit);
+  RUN_TEST(test_cancelled_pending_counts_both_puts);
+  RUN_TEST(test_counters_account_for_every_put);
+  RUN_TEST(test_min_interval_per_key);
+  RUN_TEST(test_one_commit_per_loop_pass);
+  RUN_TEST(test_long_key_same_for_read_and_write);
+  RUN_TEST(test_long_keys_with_same_prefix_differ);
+  return UNITY_END();
+}